@@ -18,8 +18,13 @@
 /*----------------------------------------------------------------------------*/
 
 #include "ControllerAFish.h"
+#include "ObstacleAvoidance.h"
 
 #include "Simulator.h"
+#include "Snapshot.h"
+#include "Parameters.h"
+#include "Appearance.h"
+#include "Counters.h"
 
 #include <cmath>
 #include <iostream>
@@ -38,6 +43,16 @@ ControllerAFish::ControllerAFish (aFish* fish)
 {
     this->fish = fish;
 
+    // named parameters, shared by all the aFish controllers
+    PARAMETER(obstacleAvoidanceSpeed);
+    PARAMETER(exploreMeanDuration);
+    PARAMETER(exploreSpeed);
+    PARAMETER(restDuration);
+    PARAMETER(brakeDuration);
+    PARAMETER(turnSpeed);
+    PARAMETER(brakeSpeed);
+    PARAMETER(attractionSpeed);
+
     reset();
 }
 
@@ -48,6 +63,7 @@ void ControllerAFish::step ()
 
     // send a message in all directions
     fish->optical->send(1);
+    COUNT("optical.sent");
     
     // receive messages
     messagesReceived = 0;
@@ -57,6 +73,7 @@ void ControllerAFish::step ()
     DeviceOpticalTransceiver::Message msg;    
     while (fish->optical->receive(msg))
     {
+	COUNT("optical.received");
 	messagesReceived++;
 	msgx += msg.direction.x();
 	msgy += msg.direction.y();
@@ -93,7 +110,7 @@ void ControllerAFish::stateExploreInit ()
     state = EXPLORE;
 
     // set robot's colour
-    fish->setColor(1, 1, 55.0/254.0);
+    Appearance::setColor(fish, 1, 1, 55.0/254.0);
 }
 
 
@@ -160,7 +177,7 @@ void ControllerAFish::stateBrakeInit ()
     stateStartTime = time;
     state = BRAKE;
 
-    fish->setColor(1, 0, 0);
+    Appearance::setColor(fish, 1, 0, 0);
 
     fish->propellerLeft->setSpeed(-brakeSpeed);
     fish->propellerRight->setSpeed(-brakeSpeed);
@@ -184,7 +201,7 @@ void ControllerAFish::stateRestInit ()
     stateStartTime = time;
     state = REST;
 
-    fish->setColor(55.0/255.0, 1, 55.0/255.0);
+    Appearance::setColor(fish, 55.0/255.0, 1, 55.0/255.0);
     
     fish->propellerLeft->setSpeed(0);
     fish->propellerRight->setSpeed(0);
@@ -245,58 +262,8 @@ void ControllerAFish::stateRest ()
 }
 
 bool ControllerAFish::obstacleAvoidance()
-{    
-    // check if an obstacle is perceived 
-    int obstaclePerceived = 0;
-
-    float pl = fish->rayFrontLU->getValue() + fish->rayFrontLD->getValue() + fish->rayLeft->getValue();
-    float pr = fish->rayFrontRU->getValue() + fish->rayFrontRD->getValue() + fish->rayRight->getValue();
-    pl /= 3.0;
-    pr /= 3.0;   
-
-    // don't take into account down obstacles, as it can be the ground...
-    if (fish->rayFrontLU->hasHit()
-//	|| fish->rayFrontLD->hasHit()
-	|| fish->rayFrontRU->hasHit()
-//	|| fish->rayFrontRD->hasHit()
-	|| fish->rayLeft->hasHit()
-	|| fish->rayRight->hasHit()
-	)
-	obstaclePerceived = 1;	    
-    
-    // no obstacles to avoid, return immediately
-    if (obstaclePerceived == 0)
-	return false;
-    
-    float leftSpeed = 0.0;
-    float rightSpeed = 0.0;
-
-    // proportional brake
-    if (pr > obstacleAvoidanceThreshold && pl > obstacleAvoidanceThreshold)
-    {
-	// break symmetry
-	leftSpeed = -brakeSpeed * pr / (pr + pl);
-	rightSpeed = -brakeSpeed * pl / (pr + pl);	
-    }
-    // turn left
-    if (pr >= pl)
-    {
-	leftSpeed = -obstacleAvoidanceSpeed + 0.01;
-	rightSpeed = obstacleAvoidanceSpeed + 0.01;
-    }
-    // turn right
-    else
-    {
-	leftSpeed = obstacleAvoidanceSpeed + 0.01;
-	rightSpeed = -obstacleAvoidanceSpeed + 0.01;
-    }
-    
-    // change movement direction
-    fish->propellerLeft->setSpeed(leftSpeed);
-    fish->propellerRight->setSpeed(rightSpeed);
-
-    // advertise obstacle avoidance in progress
-    return true;
+{
+    return ObstacleAvoidance::avoid(fish, obstacleAvoidanceSpeed, 0.01);
 }
 
 
@@ -317,4 +284,17 @@ void ControllerAFish::reset ()
     stateExploreInit();
 }
 
-
+void ControllerAFish::snapshot (Snapshot& s)
+{
+    // dynamic state only, parameters come from the command line
+    s.io(state);
+    s.io(time);
+    s.io(stateDuration);
+    s.io(stateStartTime);
+    s.io(turnPreviousState);
+    s.io(turnSign);
+    s.io(messagesReceived);
+    s.io(msgx);
+    s.io(msgy);
+    s.io(attraction);
+}
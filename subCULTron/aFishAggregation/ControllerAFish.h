@@ -23,13 +23,14 @@
 #include "Controller.h"
 #include "aFish.h"
 
+class Snapshot;
+
 class ControllerAFish : public Controller
 {
 public : 
     aFish* fish;
 
     // parameters
-    float obstacleAvoidanceThreshold = 0.1;
 //    float maxProximitySensing = 0.12;
     float obstacleAvoidanceSpeed = 0.5; // 1
     float exploreMeanDuration = 5.0;
@@ -73,6 +74,7 @@ public :
     void stateTurnInit (int previousState, float angle);
     void stateTurn ();
     void reset ();
+    void snapshot (Snapshot& s);
     bool obstacleAvoidance ();
 };
 
@@ -20,7 +20,10 @@
 // Services
 #include "Experiment.h"
 
+#ifndef HEADLESS
 #include "RenderOSG.h"
+#include "InstancedRender.h"
+#endif
 #include "PhysicsBullet.h"
 #include "WaterVolume.h"
 
@@ -33,12 +36,24 @@
 #include "Experiment.h"
 
 // Utilities
+#include "Parameters.h"
+#include "TrajectoryRecorder.h"
+#include "TrajectoryPlayer.h"
+#include "FastReset.h"
+#include "Interrupt.h"
+#include "Placement.h"
+#include "Profiler.h"
+#include "Counters.h"
+#include "Snapshot.h"
 #include <gsl/gsl_rng.h>
 #include <gsl/gsl_randist.h>
 #include <sys/time.h>
 
+#include <algorithm>
+#include <functional>
 #include <iostream>
 #include <fstream>
+#include <map>
 #include <tinyxml.h>
 
 extern gsl_rng* rng;
@@ -62,25 +77,42 @@ btVector3 calculateWaterVolumeCurrent(btVector3 pos, float time)
 
 Experiment::Experiment (Simulator* simulator, bool graphics)
 {
+    // named parameters, may be overridden before the world is built
+    PARAMETER(aFishCount);
+    PARAMETER(aPadCount);
+    PARAMETER(aMusselCount);
+    PARAMETER(maxTime);
+    PARAMETER(aquariumRadius);
+    PARAMETER(recordPeriod);
+    PARAMETER(clusterDistance);
+    PARAMETER(earlyStop);
+    PARAMETER(stopClusterDuration);
+
     // random number generation
     init_rng(&rng);        
 
     // add services
     simulator->setTimestep (0.05);
-    physics = new PhysicsBullet();
+    physics = new Profiled<PhysicsBullet> ();
     physics->setTimestep(0.05);
-    simulator->add (physics);
+    Counters::world(physics);
+    // a replay sets the poses itself, the world is not simulated
+    if (!TrajectoryPlayer::replay)
+	simulator->add (physics);
 
-    waterVolume = new WaterVolume();
+    waterVolume = new Profiled<WaterVolume> ();
     waterVolume->setDensity(1000);
     waterVolume->setHeightCallback(calculateWaterVolumeHeight);
-    simulator->add (waterVolume);
+    if (!TrajectoryPlayer::replay)
+	simulator->add (waterVolume);
     
     render = NULL;
+#ifndef HEADLESS
     if (graphics)
     {	
-	render = new RenderOSG(simulator);
-	simulator->add (render);
+	render = new Profiled<RenderOSG> (simulator);
+	if (!InstancedRender::decoupled)
+	    simulator->add (render);
 
 	// setup camera of the render service
 	render->viewer->getCamera()->setProjectionMatrixAsPerspective(45.0, 1.0, 0.1, 1000); 
@@ -91,9 +123,13 @@ Experiment::Experiment (Simulator* simulator, bool graphics)
 	manip->setElevation(90.0 * M_PI / 180.0);
 	manip->setHeading(0.0 * M_PI / 180.0);
     }
+#endif
 
     // add the experiment so that we can step regularly
     simulator->add (this);
+
+    // trajectories, when a file is given on the command line
+    recorder = TrajectoryRecorder::create(recordPeriod);
     
     // add aFish
     for (int i = 0; i < aFishCount; i++)
@@ -101,11 +137,12 @@ Experiment::Experiment (Simulator* simulator, bool graphics)
 	aFish* r = new aFish ();
 	r->registerService(physics);
 	r->registerService(waterVolume);
+#ifndef HEADLESS
 	if (render) 
 	{	    
-	    r->setMeshFilename ("../3dmodels/aFish.3ds.(0.015,0.015,0.015).scale");
-	    r->registerService(render); 
+	    InstancedRender::add(render, r, "../3dmodels/aFish.3ds.(0.015,0.015,0.015).scale");
 	}
+#endif
 	r->addDevices();
 //	r->optical->setDrawable(true);
 	r->optical->setReceiveOmnidirectional(true);
@@ -113,9 +150,12 @@ Experiment::Experiment (Simulator* simulator, bool graphics)
 //	r->setDragCoefficients(btVector3( 0.1, 0.4, 0.2), btVector3( 0.05, 0.1, 0.3));
 	r->setDragCoefficients(btVector3( 0.1, 0.25, 0.1), btVector3( 0.05, 0.05, 0.2));
 
-	ControllerAFish* c = new ControllerAFish (r);
+	ControllerAFish* c = new Profiled<ControllerAFish> (r);
 	r->add(c);
 	c->setTimestep(0.1);
+	controllers.push_back(c);
+	if (recorder) recorder->add(r, [c] () { return float(c->state); });
+	Counters::track(r);
 
 	aFishes.push_back(r);
 	simulator->add(r);   	
@@ -126,9 +166,25 @@ Experiment::Experiment (Simulator* simulator, bool graphics)
     AquariumCircular* aquarium = new AquariumCircular(aquariumRadius, 3.0, 40.0);
     aquarium->registerService(physics);
     aquarium->registerService(waterVolume);
+#ifndef HEADLESS
     if (render) aquarium->registerService(render);
+#endif
     simulator->add(aquarium);
 
+    // measures, available to the optimiser
+    Parameters::measure("aggregation", [this] () { return aggregation(); });
+    Parameters::measure("clusters", [this] () { return clusters(); });
+    Parameters::measure("stopTime", [this, simulator] () { return stopCriteria.stopped() ? stopCriteria.stopTime : simulator->time; });
+
+    // number of clusters unchanged for a while
+    stopCriteria.add(new StableCriterion("clusters", [this] () { return clusters(); }, stopClusterDuration));
+
+    // dynamic state, for checkpoints
+    Snapshot::provide([this] (Snapshot& s) { snapshot(s); });
+
+    if (recorder)
+	simulator->add (recorder);
+
     // set last stuff, position of robots mainly
     reset();
 }
@@ -139,20 +195,31 @@ Experiment::~Experiment()
 
 void Experiment::reset ()
 {
+    // the world is reused between replicates, only its dynamic state restarts
+    FastReset::time(simulator);
+    clusteredTime = -1;
+
+    // agents are spread without overlapping each other
+    Placement placement;
+
+    stopCriteria.reset();
+
     // reset aFish
     for (unsigned int i = 0; i < aFishes.size(); i++)
     {
 	aFish* r = aFishes[i];
 
 	// reset aFish position
-	float distance = gsl_rng_uniform(rng) * 0.8 * aquariumRadius;
-	float angle = (gsl_rng_uniform(rng) * 2.0 * M_PI - M_PI);
-	float x = cos(angle) * distance;
-	float y = sin(angle) * distance;
+	btVector3 p = placement.disc(0.8 * aquariumRadius, r->dimensions);
+	float x = p.x();
+	float y = p.y();
 	float z = 0.7 + r->dimensions[2] / 2.0;	
 
 	r->setPosition (btVector3(x, y, z));
 	r->setRotation (btQuaternion(btVector3(0, 0, 1), gsl_rng_uniform(rng) * M_PI * 2.0 - M_PI));
+	FastReset::object<ControllerAFish> (physics, r);
+	FastReset::inbox(r);
+	FastReset::propellers(r);
 	r->ballast->setBuoyancyFactor(0.0);
     }
 }
@@ -164,16 +231,111 @@ void Experiment::step ()
 void Experiment::run()
 {
     // with render, give up control and stepping is done by render
+#ifndef HEADLESS
     if (render)
     {
 	render->setPaused (true);
 	render->run();
     }
     else
+#endif
     {
-	while(simulator->time < maxTime)
+	while(simulator->time < maxTime && !Interrupt::requested() && !(earlyStop && stopCriteria.check(simulator->time)))
 	{
 	    simulator->step();
 	}
+
+	if (stopCriteria.stopped())
+	    std::cout << "Stopped by " << stopCriteria.stoppedBy << " at time " << stopCriteria.stopTime << std::endl;
+    }
+
+    if (recorder)
+	recorder->close();
+}
+
+std::vector<int> Experiment::clusterSizes ()
+{
+    // measures and stop criteria ask several times per step
+    if (clusteredTime == simulator->time)
+	return sizes;
+    clusteredTime = simulator->time;
+
+    // aFish closer than clusterDistance belong to the same cluster, only
+    // the pairs of neighbouring cells of a grid are compared
+    int n = aFishes.size();
+    std::vector<btVector3> positions (n);
+    for (int i = 0; i < n; i++)
+	positions[i] = aFishes[i]->body->getCenterOfMassTransform().getOrigin();
+
+    float cell = std::max(clusterDistance, 1e-3f);
+    auto key = [] (int i, int j) { return (int64_t(i) << 32) ^ uint32_t(j); };
+    for (auto& g : grid)
+	g.second.clear();
+    for (int i = 0; i < n; i++)
+	grid[key(floor(positions[i].x() / cell), floor(positions[i].y() / cell))].push_back(i);
+
+    // union find
+    parent.resize(n);
+    for (int i = 0; i < n; i++)
+	parent[i] = i;
+
+    std::function<int(int)> root = [&] (int i) {
+	while (parent[i] != i)
+	    i = parent[i] = parent[parent[i]];
+	return i;
+    };
+
+    float d2 = clusterDistance * clusterDistance;
+    for (int i = 0; i < n; i++)
+    {
+	int ci = floor(positions[i].x() / cell);
+	int cj = floor(positions[i].y() / cell);
+	for (int a = ci - 1; a <= ci + 1; a++)
+	    for (int b = cj - 1; b <= cj + 1; b++)
+	    {
+		auto it = grid.find(key(a, b));
+		if (it == grid.end())
+		    continue;
+		for (int j : it->second)
+		    if (j > i && positions[i].distance2(positions[j]) < d2)
+			parent[root(i)] = root(j);
+	    }
     }
+
+    std::map<int, int> count;
+    for (int i = 0; i < n; i++)
+	count[root(i)]++;
+
+    sizes.clear();
+    for (auto& c : count)
+	sizes.push_back(c.second);
+
+    return sizes;
+}
+
+float Experiment::aggregation ()
+{
+    // fraction of aFish in the largest cluster
+    if (aFishes.empty())
+	return 0.0;
+
+    std::vector<int> sizes = clusterSizes();
+    return float(*std::max_element(sizes.begin(), sizes.end())) / float(aFishes.size());
+}
+
+float Experiment::clusters ()
+{
+    return clusterSizes().size();
+}
+
+void Experiment::snapshot (Snapshot& s)
+{
+    s.io(simulator->time);
+
+    for (aFish* r : aFishes)
+	s.body(r->body);
+    for (ControllerAFish* c : controllers)
+	c->snapshot(s);
+
+    stopCriteria.snapshot(s);
 }
@@ -23,7 +23,10 @@
 #include "Simulator.h"
 #include "Service.h"
 #include "Gsl.h"
+#include "StopCriterion.h"
 
+#include <cstdint>
+#include <unordered_map>
 #include <vector>
 #include <fstream>
 
@@ -31,9 +34,12 @@
 class PhysicsBullet;
 class WaterVolume;
 class RenderOSG;
+class TrajectoryRecorder;
 class aPad;
 class aFish;
+class ControllerAFish;
 class aMussel;
+class Snapshot;
 
 class Experiment : public Service
 {
@@ -43,11 +49,17 @@ public:
     PhysicsBullet* physics;
     WaterVolume* waterVolume;
     RenderOSG* render;
+    TrajectoryRecorder* recorder;
 
     // objects
     std::vector<aFish*> aFishes;
+    std::vector<ControllerAFish*> controllers;
     std::vector<aPad*> aPads;
     std::vector<aMussel*> aMussels;
+
+    // with earlyStop (sweeps and optimisations), runs end once the
+    // clusters have settled
+    StopCriteria stopCriteria;
 	
     // parameters
     int aFishCount = 100;
@@ -55,6 +67,10 @@ public:
     int aMusselCount = 0;
     float maxTime = 3600;
     float aquariumRadius = 5.0;    
+    float recordPeriod = 0.1;
+    float clusterDistance = 0.4;
+    int earlyStop = 0;
+    float stopClusterDuration = 300;
    
     // methods
     Experiment (Simulator* s, bool graphics);
@@ -63,6 +79,19 @@ public:
     void reset ();
     void step ();
     void run();
+    void snapshot (Snapshot& s);
+
+    // measures
+    std::vector<int> clusterSizes ();
+    float aggregation ();
+    float clusters ();
+
+private :
+    // clusters of the last time measured, shared by all the measures
+    std::vector<int> sizes;
+    float clusteredTime = -1;
+    std::vector<int> parent;
+    std::unordered_map<int64_t, std::vector<int> > grid;
 };
 
 
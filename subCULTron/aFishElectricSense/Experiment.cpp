@@ -20,7 +20,10 @@
 // Services
 #include "Experiment.h"
 
+#ifndef HEADLESS
 #include "RenderOSG.h"
+#include "InstancedRender.h"
+#endif
 #include "PhysicsBullet.h"
 #include "WaterVolume.h"
 
@@ -33,6 +36,14 @@
 #include "Experiment.h"
 
 // Utilities
+#include "Parameters.h"
+#include "TrajectoryRecorder.h"
+#include "TrajectoryPlayer.h"
+#include "FastReset.h"
+#include "Interrupt.h"
+#include "Placement.h"
+#include "Profiler.h"
+#include "Counters.h"
 #include <gsl/gsl_rng.h>
 #include <gsl/gsl_randist.h>
 #include <sys/time.h>
@@ -62,25 +73,40 @@ btVector3 calculateWaterVolumeCurrent(btVector3 pos, float time)
 
 Experiment::Experiment (Simulator* simulator, bool graphics)
 {
+    // named parameters, may be overridden before the world is built
+    PARAMETER(aFishCount);
+    PARAMETER(aPadCount);
+    PARAMETER(aMusselCount);
+    PARAMETER(maxTime);
+    PARAMETER(aquariumRadius);
+    PARAMETER(recordPeriod);
+    PARAMETER(aFishActiveCount);
+
     // random number generation
     init_rng(&rng);        
 
     // add services
     simulator->setTimestep (0.05);
-    physics = new PhysicsBullet();
+    physics = new Profiled<PhysicsBullet> ();
     physics->setTimestep(0.05);
-    simulator->add (physics);
+    Counters::world(physics);
+    // a replay sets the poses itself, the world is not simulated
+    if (!TrajectoryPlayer::replay)
+	simulator->add (physics);
 
-    waterVolume = new WaterVolume();
+    waterVolume = new Profiled<WaterVolume> ();
     waterVolume->setDensity(1000);
     waterVolume->setHeightCallback(calculateWaterVolumeHeight);
-    simulator->add (waterVolume);
+    if (!TrajectoryPlayer::replay)
+	simulator->add (waterVolume);
     
     render = NULL;
+#ifndef HEADLESS
     if (graphics)
     {	
-	render = new RenderOSG(simulator);
-	simulator->add (render);
+	render = new Profiled<RenderOSG> (simulator);
+	if (!InstancedRender::decoupled)
+	    simulator->add (render);
 
 	// setup camera of the render service
 	render->viewer->getCamera()->setProjectionMatrixAsPerspective(45.0, 1.0, 0.1, 1000); 
@@ -91,9 +117,13 @@ Experiment::Experiment (Simulator* simulator, bool graphics)
 	manip->setElevation(90.0 * M_PI / 180.0);
 	manip->setHeading(0.0 * M_PI / 180.0);
     }
+#endif
 
     // add the experiment so that we can step regularly
     simulator->add (this);
+
+    // trajectories, when a file is given on the command line
+    recorder = TrajectoryRecorder::create(recordPeriod);
     
     // add aFish
     for (int i = 0; i < aFishCount; i++)
@@ -101,17 +131,18 @@ Experiment::Experiment (Simulator* simulator, bool graphics)
 	aFish* r = new aFish ();
 	r->registerService(physics);
 	r->registerService(waterVolume);
+#ifndef HEADLESS
 	if (render) 
 	{	    
-	    r->setMeshFilename ("../3dmodels/aFish.3ds.(0.01,0.01,0.01).scale");
-	    r->registerService(render); 
+	    InstancedRender::add(render, r, "../3dmodels/aFish.3ds.(0.01,0.01,0.01).scale");
 	}
+#endif
 	r->addDevices();
 //	r->optical->setDrawable(true);
 //	r->optical->setReceiveOmnidirectional(false);
 	r->setDragCoefficients(btVector3( 0.05, 0.3, 0.1), btVector3( 0.05, 0.05, 0.1));
 
-	ControllerAFish* c = new ControllerAFish (r);
+	ControllerAFish* c = new Profiled<ControllerAFish> (r);
 
 	// set dbg flag for some afish
 	if (i < aFishActiveCount)
@@ -121,6 +152,8 @@ Experiment::Experiment (Simulator* simulator, bool graphics)
 	
 	r->add(c);
 	c->setTimestep(0.1);
+	if (recorder) recorder->add(r, [c] () { return float(c->state); });
+	Counters::track(r);
 
 	aFishes.push_back(r);
 	simulator->add(r);   	
@@ -136,9 +169,14 @@ Experiment::Experiment (Simulator* simulator, bool graphics)
     AquariumCircular* aquarium = new AquariumCircular(aquariumRadius,  3.0, 40.0);
     aquarium->registerService(physics);
     aquarium->registerService(waterVolume);
+#ifndef HEADLESS
     if (render) aquarium->registerService(render);
+#endif
     simulator->add(aquarium);
 
+    if (recorder)
+	simulator->add (recorder);
+
     // set last stuff, position of robots mainly
     reset();
 }
@@ -149,20 +187,28 @@ Experiment::~Experiment()
 
 void Experiment::reset ()
 {
+    // the world is reused between replicates, only its dynamic state restarts
+    FastReset::time(simulator);
+
+    // agents are spread without overlapping each other
+    Placement placement;
+
     // reset aFish
     for (unsigned int i = 0; i < aFishes.size(); i++)
     {
 	aFish* r = aFishes[i];
 
 	// reset aFish position
-	float distance = gsl_rng_uniform(rng) * 0.8 * aquariumRadius;
-	float angle = (gsl_rng_uniform(rng) * 2.0 * M_PI - M_PI);
-	float x = cos(angle) * distance;
-	float y = sin(angle) * distance;
+	btVector3 p = placement.disc(0.8 * aquariumRadius, r->dimensions);
+	float x = p.x();
+	float y = p.y();
 	float z = 0.7 + r->dimensions[2] / 2.0;	
 
 	r->setPosition (btVector3(x, y, z));
 	r->setRotation (btQuaternion(btVector3(0, 0, 1), gsl_rng_uniform(rng) * M_PI * 2.0 - M_PI));
+	FastReset::object<ControllerAFish> (physics, r);
+	FastReset::inbox(r);
+	FastReset::propellers(r);
 	r->ballast->setBuoyancyFactor(0.0);
     }
 }
@@ -174,16 +220,21 @@ void Experiment::step ()
 void Experiment::run()
 {
     // with render, give up control and stepping is done by render
+#ifndef HEADLESS
     if (render)
     {
 	render->setPaused (true);
 	render->run();
     }
     else
+#endif
     {
-	while(simulator->time < maxTime)
+	while(simulator->time < maxTime && !Interrupt::requested())
 	{
 	    simulator->step();
 	}
     }
+
+    if (recorder)
+	recorder->close();
 }
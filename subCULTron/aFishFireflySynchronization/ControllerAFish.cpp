@@ -20,6 +20,9 @@
 #include "ControllerAFish.h"
 
 #include "Simulator.h"
+#include "Parameters.h"
+#include "Appearance.h"
+#include "Counters.h"
 
 #include <cmath>
 #include <iostream>
@@ -34,6 +37,11 @@ ControllerAFish::ControllerAFish (aFish* fish)
 {
     this->fish = fish;
 
+    // named parameters, shared by all the aFish controllers
+    PARAMETER(gamma);
+    PARAMETER(epsilon);
+    PARAMETER(refractoryPeriod);
+
     reset();
 }
 
@@ -51,24 +59,27 @@ void ControllerAFish::step ()
 	// check for messages
 	if (fish->optical->receive(msg))
 	{
+	    COUNT("optical.received");
 	    counter -= epsilon;
 	}
     }
 
-    // empty msg buffer
-    while (fish->optical->receive(msg));
+    // empty msg buffer, the remaining messages are discarded unread
+    while (fish->optical->receive(msg))
+	COUNT("optical.dropped");
 
     // blink if counter has reached timeout
     if (counter <= 0.1)
     {
 	fish->optical->send(1);
+	COUNT("optical.sent");
 	lastBlinkTime = time;
-	fish->setColor(1, 0, 0);
+	Appearance::setColor(fish, 1, 0, 0);
 	counter = 1;
     }
     else
     {
-	fish->setColor(1, 1, 55.0/254.0);
+	Appearance::setColor(fish, 1, 1, 55.0/254.0);
     }
     
 
@@ -82,7 +93,7 @@ void ControllerAFish::step ()
 void ControllerAFish::reset()
 {
     lastBlinkTime = 0;
-    fish->setColor(1, 1, 55.0/254.0);
+    Appearance::setColor(fish, 1, 1, 55.0/254.0);
 
     counter = gsl_ran_flat(rng, 0, 1);
     lastBlinkTime = -refractoryPeriod;
@@ -20,7 +20,10 @@
 // Services
 #include "Experiment.h"
 
+#ifndef HEADLESS
 #include "RenderOSG.h"
+#include "InstancedRender.h"
+#endif
 #include "PhysicsBullet.h"
 #include "WaterVolume.h"
 
@@ -33,10 +36,20 @@
 #include "Experiment.h"
 
 // Utilities
+#include "Parameters.h"
+#include "TrajectoryRecorder.h"
+#include "TrajectoryPlayer.h"
+#include "FastReset.h"
+#include "Interrupt.h"
+#include "Placement.h"
+#include "Profiler.h"
+#include "Counters.h"
 #include <gsl/gsl_rng.h>
 #include <gsl/gsl_randist.h>
 #include <sys/time.h>
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <fstream>
 #include <tinyxml.h>
@@ -62,25 +75,40 @@ btVector3 calculateWaterVolumeCurrent(btVector3 pos, float time)
 
 Experiment::Experiment (Simulator* simulator, bool graphics)
 {
+    // named parameters, may be overridden before the world is built
+    PARAMETER(aFishCount);
+    PARAMETER(maxTime);
+    PARAMETER(aquariumRadius);
+    PARAMETER(recordPeriod);
+    PARAMETER(earlyStop);
+    PARAMETER(stopSynchrony);
+    PARAMETER(stopSynchronyDuration);
+
     // random number generation
     init_rng(&rng);        
 
     // add services
     simulator->setTimestep (0.05);
-    physics = new PhysicsBullet();
+    physics = new Profiled<PhysicsBullet> ();
     physics->setTimestep(0.05);
-    simulator->add (physics);
+    Counters::world(physics);
+    // a replay sets the poses itself, the world is not simulated
+    if (!TrajectoryPlayer::replay)
+	simulator->add (physics);
 
-    waterVolume = new WaterVolume();
+    waterVolume = new Profiled<WaterVolume> ();
     waterVolume->setDensity(1000);
     waterVolume->setHeightCallback(calculateWaterVolumeHeight);
-    simulator->add (waterVolume);
+    if (!TrajectoryPlayer::replay)
+	simulator->add (waterVolume);
     
     render = NULL;
+#ifndef HEADLESS
     if (graphics)
     {	
-	render = new RenderOSG(simulator);
-	simulator->add (render);
+	render = new Profiled<RenderOSG> (simulator);
+	if (!InstancedRender::decoupled)
+	    simulator->add (render);
 
 	// setup camera of the render service
 	render->viewer->getCamera()->setProjectionMatrixAsPerspective(45.0, 1.0, 0.1, 1000); 
@@ -91,9 +119,13 @@ Experiment::Experiment (Simulator* simulator, bool graphics)
 	manip->setElevation(90.0 * M_PI / 180.0);
 	manip->setHeading(0.0 * M_PI / 180.0);
     }
+#endif
 
     // add the experiment so that we can step regularly
     simulator->add (this);
+
+    // trajectories, when a file is given on the command line
+    recorder = TrajectoryRecorder::create(recordPeriod);
     
     // add aFish
     for (int i = 0; i < aFishCount; i++)
@@ -101,11 +133,12 @@ Experiment::Experiment (Simulator* simulator, bool graphics)
 	aFish* r = new aFish ();
 	r->registerService(physics);
 	r->registerService(waterVolume);
+#ifndef HEADLESS
 	if (render) 
 	{	    
-	    r->setMeshFilename ("../3dmodels/aFish.3ds.(0.015,0.015,0.015).scale");
-	    r->registerService(render); 
+	    InstancedRender::add(render, r, "../3dmodels/aFish.3ds.(0.015,0.015,0.015).scale");
 	}
+#endif
 	r->addDevices();
 //	r->optical->setDrawable(true);
 	r->optical->setReceiveOmnidirectional(true);
@@ -113,9 +146,12 @@ Experiment::Experiment (Simulator* simulator, bool graphics)
 	r->setProximitySensorsRange(0.25);	
 	r->setDragCoefficients(btVector3( 0.1, 0.25, 0.1), btVector3( 0.05, 0.05, 0.2));
 
-	ControllerAFish* c = new ControllerAFish (r);
+	ControllerAFish* c = new Profiled<ControllerAFish> (r);
 	r->add(c);
 	c->setTimestep(0.1);
+	controllers.push_back(c);
+	if (recorder) recorder->add(r, [c] () { return float(c->counter); });
+	Counters::track(r);
 
 	aFishes.push_back(r);
 	simulator->add(r);   	
@@ -127,9 +163,21 @@ Experiment::Experiment (Simulator* simulator, bool graphics)
     AquariumCircular* aquarium = new AquariumCircular(aquariumRadius, 3.0, 40.0);
     aquarium->registerService(physics);
     aquarium->registerService(waterVolume);
+#ifndef HEADLESS
     if (render) aquarium->registerService(render);
+#endif
     simulator->add(aquarium);
 
+    // measures, available to the optimiser
+    Parameters::measure("synchrony", [this] () { return synchrony(); });
+    Parameters::measure("stopTime", [this, simulator] () { return stopCriteria.stopped() ? stopCriteria.stopTime : simulator->time; });
+
+    // synchrony must hold over several blink periods, not just a lucky instant
+    stopCriteria.add(new ThresholdCriterion("synchrony", [this] () { return synchrony(); }, stopSynchrony, false, stopSynchronyDuration));
+
+    if (recorder)
+	simulator->add (recorder);
+
     // set last stuff, position of robots mainly
     reset();
 }
@@ -140,20 +188,30 @@ Experiment::~Experiment()
 
 void Experiment::reset ()
 {
+    // the world is reused between replicates, only its dynamic state restarts
+    FastReset::time(simulator);
+
+    // agents are spread without overlapping each other
+    Placement placement;
+
+    stopCriteria.reset();
+
     // reset aFish
     for (unsigned int i = 0; i < aFishes.size(); i++)
     {
 	aFish* r = aFishes[i];
 
 	// reset aFish position
-	float distance = gsl_rng_uniform(rng) * 0.8 * aquariumRadius;
-	float angle = (gsl_rng_uniform(rng) * 2.0 * M_PI - M_PI);
-	float x = cos(angle) * distance;
-	float y = sin(angle) * distance;
+	btVector3 p = placement.disc(0.8 * aquariumRadius, r->dimensions);
+	float x = p.x();
+	float y = p.y();
 	float z = 0.7 + r->dimensions[2] / 2.0;	
 
 	r->setPosition (btVector3(x, y, z));
 	r->setRotation (btQuaternion(btVector3(0, 0, 1), gsl_rng_uniform(rng) * M_PI * 2.0 - M_PI));
+	FastReset::object<ControllerAFish> (physics, r);
+	FastReset::inbox(r);
+	FastReset::propellers(r);
 	r->ballast->setBuoyancyFactor(0.0);
 	r->optical->setRange(0.75);
     }
@@ -166,16 +224,44 @@ void Experiment::step ()
 void Experiment::run()
 {
     // with render, give up control and stepping is done by render
+#ifndef HEADLESS
     if (render)
     {
 	render->setPaused (true);
 	render->run();
     }
     else
+#endif
     {
-	while(simulator->time < maxTime)
+	while(simulator->time < maxTime && !Interrupt::requested() && !(earlyStop && stopCriteria.check(simulator->time)))
 	{
 	    simulator->step();
 	}
+
+	if (stopCriteria.stopped())
+	    std::cout << "Stopped by " << stopCriteria.stoppedBy << " at time " << stopCriteria.stopTime << std::endl;
     }
+
+    if (recorder)
+	recorder->close();
+}
+
+float Experiment::synchrony ()
+{
+    // Kuramoto order parameter : counters decay from 1 to 0.1 between two
+    // blinks, the phase is the elapsed fraction of that exponential decay
+    if (controllers.empty())
+	return 0.0;
+
+    float sx = 0.0;
+    float sy = 0.0;
+    for (ControllerAFish* c : controllers)
+    {
+	float counter = std::min(std::max(c->counter, 0.1f), 1.0f);
+	float phase = 2.0 * M_PI * log(counter) / log(0.1);
+	sx += cos(phase);
+	sy += sin(phase);
+    }
+
+    return sqrt(sx * sx + sy * sy) / controllers.size();
 }
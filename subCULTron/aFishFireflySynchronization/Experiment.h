@@ -23,6 +23,7 @@
 #include "Simulator.h"
 #include "Service.h"
 #include "Gsl.h"
+#include "StopCriterion.h"
 
 #include <vector>
 #include <fstream>
@@ -31,7 +32,9 @@
 class PhysicsBullet;
 class WaterVolume;
 class RenderOSG;
+class TrajectoryRecorder;
 class aFish;
+class ControllerAFish;
 
 class Experiment : public Service
 {
@@ -41,14 +44,24 @@ public:
     PhysicsBullet* physics;
     WaterVolume* waterVolume;
     RenderOSG* render;
+    TrajectoryRecorder* recorder;
 
     // objects
     std::vector<aFish*> aFishes;
+    std::vector<ControllerAFish*> controllers;
+
+    // with earlyStop (sweeps and optimisations), runs end once the swarm
+    // blinks in synchrony
+    StopCriteria stopCriteria;
 	
     // parameters
     int aFishCount = 100;
     float maxTime = 3600;
     float aquariumRadius = 3.0;    
+    float recordPeriod = 0.1;
+    int earlyStop = 0;
+    float stopSynchrony = 0.95;
+    float stopSynchronyDuration = 60;
    
     // methods
     Experiment (Simulator* s, bool graphics);
@@ -57,6 +70,9 @@ public:
     void reset ();
     void step ();
     void run();
+
+    // measures
+    float synchrony ();
 };
 
 
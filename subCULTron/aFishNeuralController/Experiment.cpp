@@ -0,0 +1,243 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+// Services
+#include "Experiment.h"
+
+#ifndef HEADLESS
+#include "RenderOSG.h"
+#include "InstancedRender.h"
+#endif
+#include "PhysicsBullet.h"
+#include "WaterVolume.h"
+
+// Objects
+#include "AquariumCircular.h"
+#include "aFish.h"
+
+// Controllers
+#include "BatchNeuralController.h"
+#include "Experiment.h"
+
+// Utilities
+#include "Parameters.h"
+#include "TrajectoryRecorder.h"
+#include "TrajectoryPlayer.h"
+#include "FastReset.h"
+#include "Interrupt.h"
+#include "Placement.h"
+#include "Profiler.h"
+#include "Counters.h"
+#include <gsl/gsl_rng.h>
+#include <gsl/gsl_randist.h>
+#include <sys/time.h>
+
+#include <iostream>
+#include <fstream>
+#include <tinyxml.h>
+
+extern gsl_rng* rng;
+extern long int rngSeed;
+
+float calculateWaterVolumeHeight(btVector3 pos, float time)
+{
+    float phase =  10.1 / (2.0 * M_PI);
+    float amplitude = 0.15;
+    float shift = time / M_PI * 2.0;
+    float height = 2.0 + amplitude * (sin(pos.getX() * phase + shift) * sin(pos.getY() * phase + shift));    
+    
+    return height;    
+}
+
+btVector3 calculateWaterVolumeCurrent(btVector3 pos, float time)
+{
+    return btVector3(0,0,0);
+}
+
+
+Experiment::Experiment (Simulator* simulator, bool graphics)
+{
+    // named parameters, may be overridden before the world is built
+    PARAMETER(aFishCount);
+    PARAMETER(aPadCount);
+    PARAMETER(aMusselCount);
+    PARAMETER(maxTime);
+    PARAMETER(aquariumRadius);
+    PARAMETER(recordPeriod);
+    PARAMETER(hiddenCount);
+    PARAMETER(useElectricSense);
+    PARAMETER(genomeFilename);
+
+    // random number generation
+    init_rng(&rng);        
+
+    // add services
+    simulator->setTimestep (0.05);
+    physics = new Profiled<PhysicsBullet> ();
+    physics->setTimestep(0.05);
+    Counters::world(physics);
+    // a replay sets the poses itself, the world is not simulated
+    if (!TrajectoryPlayer::replay)
+	simulator->add (physics);
+
+    waterVolume = new Profiled<WaterVolume> ();
+    waterVolume->setDensity(1000);
+    waterVolume->setHeightCallback(calculateWaterVolumeHeight);
+    if (!TrajectoryPlayer::replay)
+	simulator->add (waterVolume);
+    
+    render = NULL;
+#ifndef HEADLESS
+    if (graphics)
+    {	
+	render = new Profiled<RenderOSG> (simulator);
+	if (!InstancedRender::decoupled)
+	    simulator->add (render);
+
+	// setup camera of the render service
+	render->viewer->getCamera()->setProjectionMatrixAsPerspective(45.0, 1.0, 0.1, 1000); 
+
+	osgGA::SphericalManipulator* manip = dynamic_cast<osgGA::SphericalManipulator*>(render->viewer->getCameraManipulator());
+	manip->setDistance(15);
+	manip->setCenter(osg::Vec3(0,0,1.0));
+	manip->setElevation(90.0 * M_PI / 180.0);
+	manip->setHeading(0.0 * M_PI / 180.0);
+    }
+#endif
+
+    // add the experiment so that we can step regularly
+    simulator->add (this);
+
+    // trajectories, when a file is given on the command line
+    recorder = TrajectoryRecorder::create(recordPeriod);
+
+    // a single neural controller drives all the aFish
+    controller = new Profiled<BatchNeuralController> (hiddenCount, useElectricSense);
+    controller->setTimestep(0.1);
+    if (!controller->network.load(genomeFilename)
+	|| controller->network.inputCount() != controller->inputCount()
+	|| controller->network.outputCount() != 2)
+    {
+	controller->network.setLayers({controller->inputCount(), hiddenCount, 2});
+	std::cout << "No genome found in " << genomeFilename << ", using random weights" << std::endl;
+	controller->network.randomize(1.0);
+    }
+    controller->expose();
+    simulator->add (controller);
+    
+    // add aFish
+    for (int i = 0; i < aFishCount; i++)
+    {
+	aFish* r = new aFish ();
+	r->registerService(physics);
+	r->registerService(waterVolume);
+#ifndef HEADLESS
+	if (render) 
+	{	    
+	    InstancedRender::add(render, r, "../3dmodels/aFish.3ds.(0.01,0.01,0.01).scale");
+	}
+#endif
+	r->addDevices();
+	r->optical->setReceiveOmnidirectional(true);
+	r->setDragCoefficients(btVector3( 0.05, 0.3, 0.1), btVector3( 0.05, 0.05, 0.1));
+
+	controller->add(r);
+	if (recorder) recorder->add(r);
+	Counters::track(r);
+
+	aFishes.push_back(r);
+	simulator->add(r);   	
+	
+	// position is set in reset
+    }
+
+    AquariumCircular* aquarium = new AquariumCircular(aquariumRadius, 3.0, 40.0);
+    aquarium->registerService(physics);
+    aquarium->registerService(waterVolume);
+#ifndef HEADLESS
+    if (render) aquarium->registerService(render);
+#endif
+    simulator->add(aquarium);
+
+    if (recorder)
+	simulator->add (recorder);
+
+    // set last stuff, position of robots mainly
+    reset();
+}
+
+Experiment::~Experiment()
+{
+}
+
+void Experiment::reset ()
+{
+    // the world is reused between replicates, only its dynamic state restarts
+    FastReset::time(simulator);
+
+    // agents are spread without overlapping each other
+    Placement placement;
+
+    // reset aFish
+    for (unsigned int i = 0; i < aFishes.size(); i++)
+    {
+	aFish* r = aFishes[i];
+
+	// reset aFish position
+	btVector3 p = placement.disc(0.8 * aquariumRadius, r->dimensions);
+	float x = p.x();
+	float y = p.y();
+	float z = 0.7 + r->dimensions[2] / 2.0;	
+
+	r->setPosition (btVector3(x, y, z));
+	r->setRotation (btQuaternion(btVector3(0, 0, 1), gsl_rng_uniform(rng) * M_PI * 2.0 - M_PI));
+	FastReset::body(physics, r);
+	FastReset::inbox(r);
+	FastReset::propellers(r);
+	r->ballast->setBuoyancyFactor(0.0);
+    }
+
+    controller->reset();
+}
+
+void Experiment::step ()
+{       
+}
+
+void Experiment::run()
+{
+    // with render, give up control and stepping is done by render
+#ifndef HEADLESS
+    if (render)
+    {
+	render->setPaused (true);
+	render->run();
+    }
+    else
+#endif
+    {
+	while(simulator->time < maxTime && !Interrupt::requested())
+	{
+	    simulator->step();
+	}
+    }
+
+    if (recorder)
+	recorder->close();
+}
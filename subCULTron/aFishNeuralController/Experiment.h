@@ -0,0 +1,78 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#ifndef EXPERIMENT_H
+#define EXPERIMENT_H
+
+#include "Simulator.h"
+#include "Service.h"
+#include "Gsl.h"
+
+#include <vector>
+#include <fstream>
+#include <string>
+
+
+class PhysicsBullet;
+class WaterVolume;
+class RenderOSG;
+class TrajectoryRecorder;
+class aPad;
+class aFish;
+class aMussel;
+class BatchNeuralController;
+
+class Experiment : public Service
+{
+public:
+
+    // services
+    PhysicsBullet* physics;
+    WaterVolume* waterVolume;
+    RenderOSG* render;
+    TrajectoryRecorder* recorder;
+    BatchNeuralController* controller;
+
+    // objects
+    std::vector<aFish*> aFishes;
+    std::vector<aPad*> aPads;
+    std::vector<aMussel*> aMussels;
+	
+    // parameters
+    int aFishCount = 100;
+    int aPadCount = 0;
+    int aMusselCount = 0;
+    float maxTime = 3600;
+    float aquariumRadius = 5.0;    
+    float recordPeriod = 0.1;
+    int hiddenCount = 8;
+    int useElectricSense = 0;
+    std::string genomeFilename = "genome.txt";
+   
+    // methods
+    Experiment (Simulator* s, bool graphics);
+    ~Experiment ();
+
+    void reset ();
+    void step ();
+    void run();
+};
+
+
+#endif
@@ -0,0 +1,75 @@
+
+
+solution "experiment"
+   configurations { "debug", "release", "headless" }
+
+   --- ============================= LINUX ==================================
+   if os.is ("linux") then
+
+      includedirs { "/usr/include/libfamous" }
+      includedirs { "/usr/local/include/libfamous" }
+      includedirs { "/usr/include/bullet" }
+      includedirs { "/usr/include/eigen3" }
+
+      libdirs { os.findlib("glut"), os.findlib("GL"), os.findlib("GLU"), 
+      	        os.findlib("gsl"), os.findlib("BulletDynamics"), 
+                os.findlib("boost_program_options"), os.findlib("tinyxml"),
+		os.findlib("famous")}
+      
+      links { "famous", "BulletDynamics", "BulletCollision", "LinearMath", 
+              "gsl", "gslcblas", "boost_program_options", 
+              "tinyxml", "z", "pthread"}
+
+      -- render libraries, left out of headless builds
+      configuration "not headless"
+         links { "glut", "GL", "GLU", "osg", "osgGA", "osgDB", "osgUtil", "osgViewer", "osgText" }
+      configuration {}
+
+
+   --- ============================= MACOSX =================================
+    elseif os.is ("macosx") then
+
+      includedirs { "/opt/local/include/libfamous" }
+      includedirs { "/opt/local/include/bullet" }
+      includedirs { "/opt/local/include" }
+
+      libdirs { os.findlib("glut"), os.findlib("GL"), os.findlib("GLU"), 
+                os.findlib("gsl"), os.findlib("BulletDynamics"), 
+                os.findlib("boost_program_options"), os.findlib("tinyxml")}
+
+      libdirs { "/opt/local/lib" }
+
+      links { "famous", "BulletDynamics", "BulletCollision", "LinearMath", 
+              "gsl", "gslcblas", "boost_program_options-mt", "tinyxml", "z"}
+
+      configuration "not headless"
+         links { "glut", "GL", "GLU" }
+      configuration {}
+
+   end
+
+
+   --- ============================= GENERIC =================================
+
+   project "experiment"
+      kind "ConsoleApp"
+      language "C++"
+      files { "**.h", "**.cpp" }
+      files { "../common/**.h", "../common/**.cpp" }
+      includedirs { "../common" }
+
+      configuration "release"
+         buildoptions {"-std=c++11"}
+         defines { "NDEBUG" }
+         flags { "OptimizeSpeed", "EnableSSE", "EnableSSE2", "FloatFast", "NoFramePointer"}    
+
+      -- no render at all : no OSG, no GL, meshes and fonts are never loaded
+      configuration "headless"
+         buildoptions {"-std=c++11"}
+         defines { "NDEBUG", "HEADLESS" }
+         flags { "OptimizeSpeed", "EnableSSE", "EnableSSE2", "FloatFast", "NoFramePointer"}    
+
+      configuration "debug"
+         buildoptions {"-std=c++11"}
+         defines { "DEBUG" }
+         flags { "Symbols" }
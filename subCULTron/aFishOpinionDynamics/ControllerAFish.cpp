@@ -18,8 +18,14 @@
 /*----------------------------------------------------------------------------*/
 
 #include "ControllerAFish.h"
+#include "ObstacleAvoidance.h"
 
 #include "Simulator.h"
+#include "Snapshot.h"
+#include "Parameters.h"
+#include "Appearance.h"
+#include "Counters.h"
+#include "Log.h"
 
 #include <cmath>
 #include <iostream>
@@ -38,6 +44,14 @@ ControllerAFish::ControllerAFish (aFish* fish)
 {
     this->fish = fish;
 
+    // named parameters, shared by all the aFish controllers
+    PARAMETER(obstacleAvoidanceSpeed);
+    PARAMETER(exploreMeanDuration);
+    PARAMETER(exploreSpeed);
+    PARAMETER(turnSpeed);
+    PARAMETER(fermiCoeff);
+    PARAMETER(blinkProba);
+
     reset();
 }
 
@@ -50,17 +64,20 @@ void ControllerAFish::diffuseAndUpdateOpinion()
 	int m = (opinion << 8) + int (confidence * 255);
 	
 	fish->optical->send(m);
-	fish->setColor(1, 0, 0);
+	COUNT("optical.sent");
+	Appearance::setColor(fish, 1, 0, 0);
     }
     else
-	fish->setColor(1, 1, 55.0/254.0);
+	Appearance::setColor(fish, 1, 1, 55.0/254.0);
 
 
     // if a message is received, record data
+    int previousOpinion = opinion;
     bool messageReceived = false;
     DeviceOpticalTransceiver::Message msg;
     while (fish->optical->receive(msg))
     {
+	COUNT("optical.received");
 	// decode msg content, contains opinion + confidence
 	int op = msg.content >> 8;
 	float conf = float(msg.content & 255) / 255.0;
@@ -79,7 +96,8 @@ void ControllerAFish::diffuseAndUpdateOpinion()
     }
 
     // update local text displayed
-    fish->setText(to_string(opinion));
+    if (opinion != previousOpinion)
+	Appearance::setText(fish, to_string(opinion));
 }
 
 void ControllerAFish::step ()
@@ -104,7 +122,7 @@ void ControllerAFish::stateExploreInit ()
     state = EXPLORE;
 
     // set robot's colour
-    fish->setColor(1, 1, 55.0/254.0);
+    Appearance::setColor(fish, 1, 1, 55.0/254.0);
 }
 
 
@@ -160,58 +178,8 @@ void ControllerAFish::stateTurn()
 
 
 bool ControllerAFish::obstacleAvoidance()
-{    
-    // check if an obstacle is perceived 
-    int obstaclePerceived = 0;
-
-    float pl = fish->rayFrontLU->getValue() + fish->rayFrontLD->getValue() + fish->rayLeft->getValue();
-    float pr = fish->rayFrontRU->getValue() + fish->rayFrontRD->getValue() + fish->rayRight->getValue();
-    pl /= 3.0;
-    pr /= 3.0;   
-
-    // don't take into account down obstacles, as it can be the ground...
-    if (fish->rayFrontLU->hasHit()
-//	|| fish->rayFrontLD->hasHit()
-	|| fish->rayFrontRU->hasHit()
-//	|| fish->rayFrontRD->hasHit()
-	|| fish->rayLeft->hasHit()
-	|| fish->rayRight->hasHit()
-	)
-	obstaclePerceived = 1;	    
-    
-    // no obstacles to avoid, return immediately
-    if (obstaclePerceived == 0)
-	return false;
-    
-    float leftSpeed = 0.0;
-    float rightSpeed = 0.0;
-
-    // proportional break
-    if (pr > obstacleAvoidanceThreshold && pl > obstacleAvoidanceThreshold)
-    {
-	// break symmetry
-	leftSpeed = -breakSpeed * pr / (pr + pl);
-	rightSpeed = -breakSpeed * pl / (pr + pl);	
-    }
-    // turn left
-    if (pr >= pl)
-    {
-	leftSpeed = -obstacleAvoidanceSpeed;
-	rightSpeed = obstacleAvoidanceSpeed;
-    }
-    // turn right
-    else
-    {
-	leftSpeed = obstacleAvoidanceSpeed;
-	rightSpeed = -obstacleAvoidanceSpeed;
-    }
-    
-    // change movement direction
-    fish->propellerLeft->setSpeed(leftSpeed);
-    fish->propellerRight->setSpeed(rightSpeed);
-
-    // advertise obstacle avoidance in progress
-    return true;
+{
+    return ObstacleAvoidance::avoid(fish, obstacleAvoidanceSpeed);
 }
 
 
@@ -240,9 +208,22 @@ void ControllerAFish::reset ()
     // associate a random confidence interval
     confidence = gsl_ran_flat (rng, 0, 1);
 
-    cout << "aFish " << this << " initial opinion / confidence " << opinion << " " << confidence << endl;
-    fish->setTextDrawable(true);
-    fish->setText(to_string(opinion));
+    LOG(LOG_DEBUG) << "aFish " << this << " initial opinion / confidence " << opinion << " " << confidence;
+    Appearance::setText(fish, to_string(opinion));
 }
 
-
+void ControllerAFish::snapshot (Snapshot& s)
+{
+    // dynamic state only, parameters come from the command line
+    s.io(state);
+    s.io(time);
+    s.io(opinion);
+    s.io(confidence);
+    s.io(exploreDuration);
+    s.io(exploreStartTime);
+    s.io(turnPreviousState);
+    s.io(turnDuration);
+    s.io(turnStartTime);
+    s.io(turnSign);
+    s.io(collisionsDecisionLastTime);
+}
@@ -23,19 +23,19 @@
 #include "Controller.h"
 #include "aFish.h"
 
+class Snapshot;
+
 class ControllerAFish : public Controller
 {
 public : 
     aFish* fish;
     
     // parameters
-    float obstacleAvoidanceThreshold = 0.05;
 //    float maxProximitySensing = 0.12;
     float obstacleAvoidanceSpeed = 0.99;
     float exploreMeanDuration = 5.0;
     float exploreSpeed = 0.05;
     float turnSpeed = 0.3;
-    float breakSpeed = 1;
 
     int opinion;
     float confidence;
@@ -72,6 +72,7 @@ public :
     void stateTurnInit (int previousState, float angle);
     void stateTurn ();
     void reset ();
+    void snapshot (Snapshot& s);
     bool obstacleAvoidance ();
 };
 
@@ -23,6 +23,7 @@
 #include "Simulator.h"
 #include "Service.h"
 #include "Gsl.h"
+#include "StopCriterion.h"
 
 #include <vector>
 #include <fstream>
@@ -31,9 +32,12 @@
 class PhysicsBullet;
 class WaterVolume;
 class RenderOSG;
+class TrajectoryRecorder;
 class aPad;
 class aFish;
+class ControllerAFish;
 class aMussel;
+class Snapshot;
 
 class Experiment : public Service
 {
@@ -43,11 +47,17 @@ public:
     PhysicsBullet* physics;
     WaterVolume* waterVolume;
     RenderOSG* render;
+    TrajectoryRecorder* recorder;
 
     // objects
     std::vector<aFish*> aFishes;
+    std::vector<ControllerAFish*> controllers;
     std::vector<aPad*> aPads;
     std::vector<aMussel*> aMussels;
+
+    // with earlyStop (sweeps and optimisations), runs end once consensus
+    // is reached
+    StopCriteria stopCriteria;
 	
     // parameters
     int aFishCount = 40;
@@ -55,6 +65,9 @@ public:
     int aMusselCount = 0;
     float maxTime = 3600;
     float aquariumRadius = 3.0;    
+    float recordPeriod = 0.1;
+    int earlyStop = 0;
+    float stopEntropy = 0.01;
    
     // methods
     Experiment (Simulator* s, bool graphics);
@@ -63,6 +76,11 @@ public:
     void reset ();
     void step ();
     void run();
+    void snapshot (Snapshot& s);
+
+    // measures
+    float consensus ();
+    float entropy ();
 };
 
 
@@ -1,7 +1,7 @@
 
 
 solution "experiment"
-   configurations { "debug", "release" , "profile" }
+   configurations { "debug", "release", "headless" }
 
    --- ============================= LINUX ==================================
    if os.is ("linux") then
@@ -17,8 +17,13 @@ solution "experiment"
 		os.findlib("famous")}
       
       links { "famous", "BulletDynamics", "BulletCollision", "LinearMath", 
-              "gsl", "gslcblas", "glut", "GL", "GLU", "boost_program_options", 
-              "tinyxml", "osg", "osgGA", "osgDB", "osgViewer", "osgText"}
+              "gsl", "gslcblas", "boost_program_options", 
+              "tinyxml", "z", "pthread"}
+
+      -- render libraries, left out of headless builds
+      configuration "not headless"
+         links { "glut", "GL", "GLU", "osg", "osgGA", "osgDB", "osgUtil", "osgViewer", "osgText" }
+      configuration {}
 
 
    --- ============================= MACOSX =================================
@@ -35,7 +40,11 @@ solution "experiment"
       libdirs { "/opt/local/lib" }
 
       links { "famous", "BulletDynamics", "BulletCollision", "LinearMath", 
-              "gsl", "gslcblas", "glut", "GL", "GLU", "boost_program_options-mt", "tinyxml"}
+              "gsl", "gslcblas", "boost_program_options-mt", "tinyxml", "z"}
+
+      configuration "not headless"
+         links { "glut", "GL", "GLU" }
+      configuration {}
 
    end
 
@@ -46,20 +55,21 @@ solution "experiment"
       kind "ConsoleApp"
       language "C++"
       files { "**.h", "**.cpp" }
+      files { "../common/**.h", "../common/**.cpp" }
+      includedirs { "../common" }
 
       configuration "release"
          buildoptions {"-std=c++11"}
          defines { "NDEBUG" }
          flags { "OptimizeSpeed", "EnableSSE", "EnableSSE2", "FloatFast", "NoFramePointer"}    
 
-      configuration "debug"
+      -- no render at all : no OSG, no GL, meshes and fonts are never loaded
+      configuration "headless"
          buildoptions {"-std=c++11"}
-         defines { "DEBUG" }
-         flags { "Symbols" }
- 
-      configuration "profile"
+         defines { "NDEBUG", "HEADLESS" }
+         flags { "OptimizeSpeed", "EnableSSE", "EnableSSE2", "FloatFast", "NoFramePointer"}    
+
+      configuration "debug"
          buildoptions {"-std=c++11"}
          defines { "DEBUG" }
          flags { "Symbols" }
-	 buildoptions { "-pg" }	
-	 linkoptions { "-pg" }	
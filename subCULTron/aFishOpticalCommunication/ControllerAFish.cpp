@@ -18,8 +18,13 @@
 /*----------------------------------------------------------------------------*/
 
 #include "ControllerAFish.h"
+#include "ObstacleAvoidance.h"
 
 #include "Simulator.h"
+#include "Parameters.h"
+#include "Appearance.h"
+#include "Counters.h"
+#include "Log.h"
 
 #include <cmath>
 #include <iostream>
@@ -39,6 +44,12 @@ ControllerAFish::ControllerAFish (aFish* fish)
 {
     this->fish = fish;
 
+    // named parameters, shared by all the aFish controllers
+    PARAMETER(obstacleAvoidanceSpeed);
+    PARAMETER(exploreMeanDuration);
+    PARAMETER(exploreSpeed);
+    PARAMETER(turnSpeed);
+
     reset();
 }
 
@@ -49,12 +60,14 @@ void ControllerAFish::step ()
 
     // send a message
     fish->optical->send(1);
+    COUNT("optical.sent");
     
     // receive messages
     DeviceOpticalTransceiver::Message msg;
     while (fish->optical->receive(msg))
     {
-	if (dbg) cout << this << " fish received msg " << msg.content << " at time " << time << endl;
+	COUNT("optical.received");
+	LOG_IF(LOG_DEBUG, dbg) << this << " fish received msg " << msg.content << " at time " << time;
     }
 
     
@@ -74,7 +87,7 @@ void ControllerAFish::stateExploreInit ()
     state = EXPLORE;
 
     // set robot's colour
-    fish->setColor(1, 1, 55.0/254.0);
+    Appearance::setColor(fish, 1, 1, 55.0/254.0);
 }
 
 
@@ -132,58 +145,8 @@ void ControllerAFish::stateTurn()
 
 
 bool ControllerAFish::obstacleAvoidance()
-{    
-    // check if an obstacle is perceived 
-    int obstaclePerceived = 0;
-
-    float pl = fish->rayFrontLU->getValue() + fish->rayFrontLD->getValue() + fish->rayLeft->getValue();
-    float pr = fish->rayFrontRU->getValue() + fish->rayFrontRD->getValue() + fish->rayRight->getValue();
-    pl /= 3.0;
-    pr /= 3.0;   
-
-    // don't take into account down obstacles, as it can be the ground...
-    if (fish->rayFrontLU->hasHit()
-//	|| fish->rayFrontLD->hasHit()
-	|| fish->rayFrontRU->hasHit()
-//	|| fish->rayFrontRD->hasHit()
-	|| fish->rayLeft->hasHit()
-	|| fish->rayRight->hasHit()
-	)
-	obstaclePerceived = 1;	    
-    
-    // no obstacles to avoid, return immediately
-    if (obstaclePerceived == 0)
-	return false;
-    
-    float leftSpeed = 0.0;
-    float rightSpeed = 0.0;
-
-    // proportional break
-    if (pr > obstacleAvoidanceThreshold && pl > obstacleAvoidanceThreshold)
-    {
-	// break symmetry
-	leftSpeed = -breakSpeed * pr / (pr + pl);
-	rightSpeed = -breakSpeed * pl / (pr + pl);	
-    }
-    // turn left
-    if (pr >= pl)
-    {
-	leftSpeed = -obstacleAvoidanceSpeed;
-	rightSpeed = obstacleAvoidanceSpeed;
-    }
-    // turn right
-    else
-    {
-	leftSpeed = obstacleAvoidanceSpeed;
-	rightSpeed = -obstacleAvoidanceSpeed;
-    }
-    
-    // change movement direction
-    fish->propellerLeft->setSpeed(leftSpeed);
-    fish->propellerRight->setSpeed(rightSpeed);
-
-    // advertise obstacle avoidance in progress
-    return true;
+{
+    return ObstacleAvoidance::avoid(fish, obstacleAvoidanceSpeed);
 }
 
 
@@ -20,6 +20,9 @@
 #include "ControllerAFish.h"
 
 #include "Simulator.h"
+#include "Parameters.h"
+#include "Appearance.h"
+#include "Counters.h"
 
 #include <cmath>
 #include <iostream>
@@ -34,6 +37,10 @@ ControllerAFish::ControllerAFish (aFish* fish)
 {
     this->fish = fish;
 
+    // named parameters, shared by all the aFish controllers
+    PARAMETER(refractoryPeriod);
+    PARAMETER(blinkProba);
+
     reset();
 }
 
@@ -50,6 +57,7 @@ void ControllerAFish::step ()
     DeviceOpticalTransceiver::Message msg;
     while (fish->optical->receive(msg))
     {
+	COUNT("optical.received");
 	messageReceived = true;
 	x += msg.direction.x();
 	y += msg.direction.y();
@@ -69,19 +77,21 @@ void ControllerAFish::step ()
 	if (rnd < blinkProba * getTimestep())
 	{
 	    fish->optical->send(1);
+	    COUNT("optical.sent");
 	    lastBlinkTime = time;
-	    fish->setColor(1, 0, 0);
+	    Appearance::setColor(fish, 1, 0, 0);
 	}
 	// relay blink ?
 	else if (messageReceived)
 	{
 	    fish->optical->send(1);
+	    COUNT("optical.sent");
 	    lastBlinkTime = time;
-	    fish->setColor(1, 0, 0);
+	    Appearance::setColor(fish, 1, 0, 0);
 	}
 	else
 	{
-	    fish->setColor(1, 1, 55.0/254.0);
+	    Appearance::setColor(fish, 1, 1, 55.0/254.0);
 	}
 
 	// get attracted towards message emitters
@@ -126,7 +136,7 @@ void ControllerAFish::step ()
 void ControllerAFish::reset()
 {
     lastBlinkTime = 0;
-    fish->setColor(1, 1, 55.0/254.0);
+    Appearance::setColor(fish, 1, 1, 55.0/254.0);
     leftSpeed = 0;
     rightSpeed = 0;
 }
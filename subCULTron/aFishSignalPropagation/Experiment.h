@@ -31,6 +31,7 @@
 class PhysicsBullet;
 class WaterVolume;
 class RenderOSG;
+class TrajectoryRecorder;
 class aPad;
 class aFish;
 class aMussel;
@@ -43,6 +44,7 @@ public:
     PhysicsBullet* physics;
     WaterVolume* waterVolume;
     RenderOSG* render;
+    TrajectoryRecorder* recorder;
 
     // objects
     std::vector<aFish*> aFishes;
@@ -55,6 +57,7 @@ public:
     int aMusselCount = 0;
     float maxTime = 3600;
     float aquariumRadius = 4.0;    
+    float recordPeriod = 0.1;
    
     // methods
     Experiment (Simulator* s, bool graphics);
@@ -19,21 +19,11 @@
 
 #include "Simulator.h"
 #include "Experiment.h"
-
-#include <iostream>
+#include "Launcher.h"
 
 	
 int main(int argc,char** argv)
 {
-    // setup and run simulated experiment
-    Simulator* simulator = new Simulator ();
-
-    bool graphics = true;
-    Experiment* exp = new Experiment (simulator, graphics);
-    exp->run();    
-
-    delete simulator;
-
-    return 0;
+    // setup and run simulated experiment, options are parsed by the launcher
+    return launch<Experiment> (argc, argv);
 }
-
@@ -20,6 +20,8 @@
 #include "ControllerAPad.h"
 
 #include "Simulator.h"
+#include "Parameters.h"
+#include "Appearance.h"
 
 #include <cmath>
 #include <iostream>
@@ -36,6 +38,11 @@ ControllerAPad::ControllerAPad (aPad* pad)
 {
     this->pad = pad;
 
+    // named parameters, shared by all the aPad controllers
+    PARAMETER(exploreMeanDuration);
+    PARAMETER(exploreSpeed);
+    PARAMETER(turnSpeed);
+
     reset();
 }
 
@@ -60,7 +67,7 @@ void ControllerAPad::stateExploreInit ()
     state = EXPLORE;
 
     // set robot's colour
-    pad->setColor(1, 1, 55.0/254.0);
+    Appearance::setColor(pad, 1, 1, 55.0/254.0);
 }
 
 
@@ -0,0 +1,108 @@
+#!/usr/bin/env python3
+# Runs every experiment headless for a fixed simulated time and seed at
+# several population scales, and compares the cost with a stored baseline.
+# Experiments are built beforehand (makeAll.sh), each run prints one JSON
+# line (--benchmark option of the launcher).
+#
+#   ./benchmark.py --save baseline.json
+#   ./benchmark.py --baseline baseline.json --tolerance 0.1
+#
+# The exit status is 1 when a run is slower or larger than the baseline by
+# more than the tolerance, or fails.
+
+import argparse
+import glob
+import json
+import os
+import subprocess
+import sys
+
+
+def experiments():
+    here = os.path.dirname(os.path.abspath(__file__))
+    return sorted(os.path.basename(os.path.dirname(p)) for p in glob.glob(os.path.join(here, "*", "premake4.lua"))
+                  if os.path.basename(os.path.dirname(p)) != "common")
+
+
+def run(name, scale, args):
+    here = os.path.dirname(os.path.abspath(__file__))
+    directory = os.path.join(here, name)
+    command = ["./experiment", "--benchmark", "--seed", str(args.seed), "--scale", str(scale),
+               "--set", "maxTime=%g" % args.time]
+    try:
+        out = subprocess.run(command, cwd=directory, stdout=subprocess.PIPE, stderr=subprocess.DEVNULL,
+                             universal_newlines=True, timeout=args.timeout).stdout
+    except (OSError, subprocess.TimeoutExpired) as e:
+        print("%s x%g : %s" % (name, scale, e), file=sys.stderr)
+        return None
+
+    # the launcher prints the result last, after the messages of the run
+    lines = [l for l in out.splitlines() if l.startswith("{")]
+    if not lines:
+        print("%s x%g : no result" % (name, scale), file=sys.stderr)
+        return None
+
+    result = json.loads(lines[-1])
+    result["experiment"] = name
+    return result
+
+
+def key(result):
+    return "%s x%g" % (result["experiment"], result["scale"])
+
+
+def main():
+    parser = argparse.ArgumentParser(description="benchmark all experiments")
+    parser.add_argument("experiments", nargs="*", help="experiment directories, all by default")
+    parser.add_argument("--time", type=float, default=60.0, help="simulated time of each run")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--scales", default="0.5,1,2", help="population factors, comma separated")
+    parser.add_argument("--timeout", type=float, default=3600.0, help="wall time limit of a run, in seconds")
+    parser.add_argument("--save", help="write the results to this file")
+    parser.add_argument("--baseline", help="compare with results saved before")
+    parser.add_argument("--tolerance", type=float, default=0.1, help="relative slowdown or growth allowed")
+    args = parser.parse_args()
+
+    names = args.experiments or experiments()
+    scales = [float(s) for s in args.scales.split(",")]
+
+    results = []
+    failed = False
+    print("%-40s %8s %12s %14s %12s" % ("run", "agents", "steps/s", "ns/agent-step", "peak RSS MB"))
+    for name in names:
+        for scale in scales:
+            r = run(name, scale, args)
+            if r is None:
+                failed = True
+                continue
+            results.append(r)
+            print("%-40s %8d %12.1f %14.1f %12.1f" % (key(r), r["agents"], r["stepsPerSecond"],
+                                                      r["nsPerAgentStep"], r["peakRssKB"] / 1024.0))
+
+    if args.save:
+        with open(args.save, "w") as f:
+            json.dump({"time": args.time, "seed": args.seed, "results": results}, f, indent=1)
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+        if baseline["time"] != args.time or baseline["seed"] != args.seed:
+            print("baseline was run with time %g and seed %d" % (baseline["time"], baseline["seed"]), file=sys.stderr)
+            return 1
+
+        reference = dict((key(r), r) for r in baseline["results"])
+        for r in results:
+            b = reference.get(key(r))
+            if b is None:
+                continue
+            for measure in ("nsPerAgentStep", "peakRssKB"):
+                if b[measure] > 0 and r[measure] > b[measure] * (1.0 + args.tolerance):
+                    print("REGRESSION %s : %s %.1f, baseline %.1f (+%.0f%%)"
+                          % (key(r), measure, r[measure], b[measure], 100.0 * (r[measure] / b[measure] - 1.0)))
+                    failed = True
+
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,126 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#include "Appearance.h"
+#include "Object.h"
+
+#ifndef HEADLESS
+#include "RenderOSG.h"
+
+#include <osg/Node>
+#endif
+
+std::unordered_map<Object*, Appearance::Look> Appearance::looks;
+std::vector<Object*> Appearance::changed;
+
+
+#ifndef HEADLESS
+// changes of the last steps, shown before each frame
+class AppearanceUpdate : public osg::NodeCallback
+{
+public :
+    void operator() (osg::Node* node, osg::NodeVisitor* nv)
+    {
+	Appearance::flush();
+	traverse(node, nv);
+    }
+};
+#endif
+
+void Appearance::setColor (Object* object, float r, float g, float b)
+{
+    setColor(object, r, g, b, 1.0);
+}
+
+void Appearance::setColor (Object* object, float r, float g, float b, float a)
+{
+    auto it = looks.find(object);
+    if (it != looks.end())
+    {
+	const float* c = it->second.color;
+	if (c[0] == r && c[1] == g && c[2] == b && c[3] == a)
+	    return;
+    }
+
+    Look& l = it != looks.end() ? it->second : looks[object];
+    l.color[0] = r;
+    l.color[1] = g;
+    l.color[2] = b;
+    l.color[3] = a;
+
+#ifndef HEADLESS
+    if (!l.colorChanged && !l.textChanged)
+	changed.push_back(object);
+    l.colorChanged = true;
+#endif
+}
+
+void Appearance::setText (Object* object, const std::string& text)
+{
+    auto it = looks.find(object);
+    if (it != looks.end() && it->second.text == text)
+	return;
+
+    Look& l = it != looks.end() ? it->second : looks[object];
+    l.text = text;
+
+#ifndef HEADLESS
+    if (!l.colorChanged && !l.textChanged)
+	changed.push_back(object);
+    l.textChanged = true;
+#endif
+}
+
+const Appearance::Look& Appearance::get (Object* object)
+{
+    // objects never set keep the default look, without an entry
+    static const Look none;
+    auto it = looks.find(object);
+    return it != looks.end() ? it->second : none;
+}
+
+void Appearance::clear ()
+{
+    looks.clear();
+    changed.clear();
+}
+
+void Appearance::attach (RenderOSG* render)
+{
+#ifndef HEADLESS
+    osg::Node* scene = render ? render->viewer->getSceneData() : NULL;
+    if (scene)
+	scene->addUpdateCallback(new AppearanceUpdate ());
+#endif
+}
+
+void Appearance::flush ()
+{
+    for (Object* object : changed)
+    {
+	Look& l = looks[object];
+	if (l.colorChanged)
+	    object->setColor(l.color[0], l.color[1], l.color[2], l.color[3]);
+	if (l.textChanged)
+	    object->setText(l.text);
+	l.colorChanged = false;
+	l.textChanged = false;
+    }
+    changed.clear();
+}
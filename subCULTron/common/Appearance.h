@@ -0,0 +1,67 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#ifndef APPEARANCE_H
+#define APPEARANCE_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Object;
+class RenderOSG;
+
+// Colour and text given to objects, remembered so that they can be recorded
+// with the trajectories. Controllers and experiments call these instead of
+// Object::setColor and Object::setText.
+//
+// Setting the colour or text an object already has costs a lookup. Real
+// changes are only handed to the objects once per frame of the render they
+// are attached to, without render (and in headless builds) the looks are
+// only remembered.
+class Appearance
+{
+public :
+    struct Look
+    {
+	float color[4] = {1.0, 1.0, 1.0, 1.0};
+	std::string text;
+	// not shown yet
+	bool colorChanged = false;
+	bool textChanged = false;
+    };
+
+    static void setColor (Object* object, float r, float g, float b);
+    static void setColor (Object* object, float r, float g, float b, float a);
+    static void setText (Object* object, const std::string& text);
+
+    // the default look for objects never set
+    static const Look& get (Object* object);
+    static void clear ();
+
+    static void attach (RenderOSG* render);
+    static void flush ();
+
+private :
+    static std::unordered_map<Object*, Look> looks;
+    static std::vector<Object*> changed;
+};
+
+
+#endif
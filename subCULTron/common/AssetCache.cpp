@@ -0,0 +1,182 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+// models are only read for the render, not built in headless mode
+#ifndef HEADLESS
+
+#include "AssetCache.h"
+#include "LevelOfDetail.h"
+
+#include <osg/CopyOp>
+#include <osg/Version>
+#include <osgDB/FileNameUtils>
+#include <osgDB/FileUtils>
+#include <osgDB/ReadFile>
+#include <osgDB/WriteFile>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <unistd.h>
+
+osg::ref_ptr<AssetCache> AssetCache::instance;
+std::string AssetCache::directory;
+
+
+// FNV-1a, enough to tell versions of a model apart
+static uint64_t hash (const char* data, size_t size, uint64_t h = 14695981039346656037ULL)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+	h ^= (unsigned char) data[i];
+	h *= 1099511628211ULL;
+    }
+
+    return h;
+}
+
+// file read by a pseudo loader : "model.3ds.(0.01,0.01,0.01).scale" is
+// read from "model.3ds"
+static std::string sourceFilename (std::string filename)
+{
+    for (;;)
+    {
+	std::string extension = osgDB::getLowerCaseFileExtension(filename);
+	if (extension != "scale" && extension != "rot" && extension != "trans")
+	    return filename;
+
+	filename = osgDB::getNameLessExtension(filename);
+	size_t arguments = filename.rfind(".(");
+	if (arguments == std::string::npos)
+	    return filename;
+	filename.erase(arguments);
+    }
+}
+
+
+void AssetCache::install ()
+{
+    if (instance.valid())
+	return;
+
+    instance = new AssetCache ();
+    osgDB::Registry::instance()->setReadFileCallback(instance.get());
+}
+
+void AssetCache::clear ()
+{
+    if (!instance.valid())
+	return;
+
+    std::lock_guard<std::mutex> lock (instance->mutex);
+    instance->nodes.clear();
+}
+
+osgDB::ReaderWriter::ReadResult AssetCache::readNode (const std::string& filename, const osgDB::Options* options)
+{
+    osg::ref_ptr<osg::Node> node;
+    {
+	std::lock_guard<std::mutex> lock (mutex);
+	auto it = nodes.find(filename);
+	if (it != nodes.end())
+	    node = it->second;
+    }
+
+    if (!node.valid())
+    {
+	std::string cached = cacheFilename(filename, options);
+	if (!cached.empty() && osgDB::fileExists(cached))
+	{
+	    osgDB::ReaderWriter::ReadResult result = osgDB::Registry::instance()->readNodeImplementation(cached, options);
+	    if (result.validNode())
+		node = result.getNode();
+	}
+
+	if (!node.valid())
+	{
+	    osgDB::ReaderWriter::ReadResult result = osgDB::Registry::instance()->readNodeImplementation(filename, options);
+	    if (!result.validNode())
+	    {
+		std::cerr << "AssetCache : cannot read " << filename << std::endl;
+		return result;
+	    }
+	    node = result.getNode();
+
+	    // levels of detail of the model file itself, pseudo loaders wrap them
+	    if (sourceFilename(filename) == filename)
+		node = LevelOfDetail::build(node.get());
+
+	    // written aside then renamed, concurrent launches may write the same model
+	    if (!cached.empty() && osgDB::makeDirectoryForFile(cached))
+	    {
+		std::ostringstream partial;
+		partial << osgDB::getNameLessExtension(cached) << "." << getpid() << ".osgb";
+		osg::ref_ptr<osgDB::Options> embed = new osgDB::Options ("WriteImageHint=IncludeData");
+		if (!osgDB::writeNodeFile(*node, partial.str(), embed.get())
+		    || rename(partial.str().c_str(), cached.c_str()) != 0)
+		{
+		    std::cerr << "AssetCache : cannot write " << cached << std::endl;
+		    remove(partial.str().c_str());
+		}
+	    }
+	}
+
+	std::lock_guard<std::mutex> lock (mutex);
+	nodes[filename] = node;
+    }
+
+    // own graph and state, shared geometry data
+    return osg::clone(node.get(), osg::CopyOp::DEEP_COPY_NODES
+		      | osg::CopyOp::DEEP_COPY_DRAWABLES
+		      | osg::CopyOp::DEEP_COPY_STATESETS
+		      | osg::CopyOp::DEEP_COPY_STATEATTRIBUTES);
+}
+
+std::string AssetCache::cacheFilename (const std::string& filename, const osgDB::Options* options)
+{
+    if (directory == "none")
+	return "";
+
+    std::string source = osgDB::findDataFile(sourceFilename(filename), options);
+    std::ifstream file (source.c_str(), std::ios::binary);
+    if (source.empty() || !file)
+	return "";
+
+    std::ostringstream content;
+    content << file.rdbuf();
+    std::string data = content.str();
+
+    std::string key = filename + "\n" + osgGetVersion() + "\n" + std::to_string(LevelOfDetail::triangles);
+    if (options)
+	key += "\n" + options->getOptionString();
+
+    uint64_t h = hash(data.data(), data.size());
+    h = hash(key.data(), key.size(), h);
+
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.osgb", (unsigned long long) h);
+
+    std::string dir = directory.empty() ? osgDB::concatPaths(osgDB::getFilePath(source), "cache") : directory;
+    return osgDB::concatPaths(dir, name);
+}
+
+#endif
@@ -0,0 +1,62 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#ifndef ASSET_CACHE_H
+#define ASSET_CACHE_H
+
+#include <osgDB/Registry>
+
+#include <map>
+#include <mutex>
+#include <string>
+
+// Models read through osgDB (Object::setMeshFilename, the .scale pseudo
+// loader included) are parsed once per process and kept for every later
+// object and replicate. Each object gets its own copy of the scene graph and
+// state, so that colours stay per object, while geometry, vertex arrays and
+// primitives are shared.
+//
+// Parsed models are also written in the native binary format (.osgb) to a
+// cache directory, named after a hash of the model file, the loader options,
+// the OSG version and the level of detail settings (LevelOfDetail). Later launches read them back instead of parsing the
+// original file again, and a model which changes gets a new name.
+class AssetCache : public osgDB::ReadFileCallback
+{
+public :
+    // binary models, next to the original ones (cache/) when empty, not
+    // written at all when set to "none"
+    static std::string directory;
+
+    // methods
+    static void install ();
+    static void clear ();
+
+    osgDB::ReaderWriter::ReadResult readNode (const std::string& filename, const osgDB::Options* options);
+
+private :
+    static osg::ref_ptr<AssetCache> instance;
+
+    std::mutex mutex;
+    std::map<std::string, osg::ref_ptr<osg::Node> > nodes;
+
+    std::string cacheFilename (const std::string& filename, const osgDB::Options* options);
+};
+
+
+#endif
@@ -0,0 +1,189 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#include "BatchNeuralController.h"
+#include "Counters.h"
+#include "Parameters.h"
+
+#include "aFish.h"
+
+#include <algorithm>
+
+
+BatchNeuralController::BatchNeuralController (int hidden, bool electricSense)
+{
+    hiddenCount = hidden;
+    useElectricSense = electricSense;
+    PARAMETER(hiddenCount);
+    PARAMETER(maxSpeed);
+    PARAMETER(maxMessages);
+    PARAMETER(useElectricSense);
+    PARAMETER(electrodeCount);
+    PARAMETER(electricSenseGain);
+
+    // rays, optical summary, e-sense currents -> left / right propellers
+    network.setLayers({inputCount(), hiddenCount, 2});
+    appliedInputs = inputCount();
+    appliedHidden = hiddenCount;
+}
+
+BatchNeuralController::~BatchNeuralController ()
+{
+}
+
+void BatchNeuralController::add (aFish* fish)
+{
+    fishes.push_back(fish);
+}
+
+int BatchNeuralController::inputCount ()
+{
+    return 6 + 3 + (useElectricSense ? electrodeCount : 0);
+}
+
+void BatchNeuralController::expose ()
+{
+    // called once the network is loaded or randomised, values given before
+    // (e.g. by the optimizer) replace the corresponding weights
+    std::vector<float> g = network.getGenome();
+    for (unsigned int i = 0; i < g.size(); i++)
+    {
+	if (i < genome.size())
+	{
+	    genome[i] = g[i];
+	    continue;
+	}
+
+	genome.push_back(g[i]);
+	Parameters::bind("genome" + std::to_string(i), genome.back());
+    }
+
+    appliedInputs = network.inputCount();
+    appliedHidden = hiddenCount;
+    applied.clear();
+    sync();
+}
+
+void BatchNeuralController::resize ()
+{
+    // the input layer follows the sensors in use, the hidden layers
+    // follow hiddenCount once it has been changed
+    std::vector<int> layers = network.layers;
+    layers.front() = inputCount();
+    if (hiddenCount != appliedHidden)
+	for (unsigned int l = 1; l + 1 < layers.size(); l++)
+	    layers[l] = hiddenCount;
+
+    network.resize(layers);
+    expose();
+    reset();
+}
+
+void BatchNeuralController::sync ()
+{
+    int size = network.genomeSize();
+    if ((int) genome.size() < size)
+	return;
+
+    if ((int) applied.size() == size && std::equal(applied.begin(), applied.end(), genome.begin()))
+	return;
+
+    applied.assign(genome.begin(), genome.begin() + size);
+    network.setGenome(applied);
+}
+
+void BatchNeuralController::reset ()
+{
+    inputs.setZero(inputCount(), fishes.size());
+    outputs.setZero(2, fishes.size());
+}
+
+void BatchNeuralController::step ()
+{
+    // parameters may have been changed since the last step
+    if (inputCount() != appliedInputs || hiddenCount != appliedHidden)
+	resize();
+    else
+	sync();
+
+    if (inputs.cols() != (int) fishes.size())
+	reset();
+
+    gather();
+    network.forward(inputs, outputs);
+    apply();
+}
+
+void BatchNeuralController::gather ()
+{
+    for (unsigned int i = 0; i < fishes.size(); i++)
+    {
+	aFish* fish = fishes[i];
+	float* in = inputs.col(i).data();
+
+	// proximity rays
+	in[0] = fish->rayFrontLU->getValue();
+	in[1] = fish->rayFrontLD->getValue();
+	in[2] = fish->rayLeft->getValue();
+	in[3] = fish->rayFrontRU->getValue();
+	in[4] = fish->rayFrontRD->getValue();
+	in[5] = fish->rayRight->getValue();
+
+	// optical messages : amount and mean direction
+	int count = 0;
+	float mx = 0;
+	float my = 0;
+	DeviceOpticalTransceiver::Message msg;
+	while (fish->optical->receive(msg))
+	{
+	    count++;
+	    mx += msg.direction.x();
+	    my += msg.direction.y();
+	}
+	COUNT_N("optical.received", count);
+	in[6] = float(std::min(count, maxMessages)) / float(maxMessages);
+	in[7] = count > 0 ? mx / count : 0.0;
+	in[8] = count > 0 ? my / count : 0.0;
+
+	if (broadcast)
+	{
+	    fish->optical->send(1);
+	    COUNT("optical.sent");
+	}
+
+	// electric sense currents
+	if (useElectricSense)
+	{
+	    fish->esense->getCurrents();
+	    COUNT("esense.solves");
+	    int n = std::min(electrodeCount, (int) fish->esense->I.size());
+	    for (int e = 0; e < n; e++)
+		in[9 + e] = fish->esense->I(e) * electricSenseGain;
+	}
+    }
+}
+
+void BatchNeuralController::apply ()
+{
+    for (unsigned int i = 0; i < fishes.size(); i++)
+    {
+	fishes[i]->propellerLeft->setSpeed(outputs(0, i) * maxSpeed);
+	fishes[i]->propellerRight->setSpeed(outputs(1, i) * maxSpeed);
+    }
+}
@@ -0,0 +1,80 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#ifndef BATCH_NEURAL_CONTROLLER_H
+#define BATCH_NEURAL_CONTROLLER_H
+
+#include "Service.h"
+#include "NeuralNetwork.h"
+
+#include <Eigen/Eigen>
+#include <deque>
+#include <vector>
+
+class aFish;
+
+// Neural controller driving a whole swarm of aFish at once. Instead of one
+// Controller per fish, this service gathers the sensors of every fish into
+// a matrix (one column per fish), runs the network once and dispatches the
+// propeller commands.
+class BatchNeuralController : public Service
+{
+public :
+    std::vector<aFish*> fishes;
+    NeuralNetwork network;
+
+    // parameters
+    int hiddenCount = 8;
+    float maxSpeed = 0.5;
+    bool broadcast = true;
+    int maxMessages = 10;
+    int useElectricSense = 0;
+    int electrodeCount = 5;
+    float electricSenseGain = 1.0;
+
+    // working variables
+    Eigen::MatrixXf inputs;
+    Eigen::MatrixXf outputs;
+
+    // weights and biases bound as genome0, genome1, ... (a deque keeps the
+    // bound addresses valid when the network grows)
+    std::deque<float> genome;
+    std::vector<float> applied;
+    int appliedInputs;
+    int appliedHidden;
+
+    // methods
+    BatchNeuralController (int hiddenCount = 8, bool useElectricSense = false);
+    ~BatchNeuralController ();
+
+    void add (aFish* fish);
+    int inputCount ();
+    void expose ();
+    void resize ();
+    void sync ();
+
+    void reset ();
+    void step ();
+
+    void gather ();
+    void apply ();
+};
+
+
+#endif
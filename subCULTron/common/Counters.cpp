@@ -0,0 +1,187 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#include "Counters.h"
+
+#include "Simulator.h"
+#include "Object.h"
+#include "PhysicsBullet.h"
+
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+
+
+namespace
+{
+    std::mutex mutex;
+    std::vector<std::string> counterNames;
+    std::vector<Object*> trackedObjects;
+    PhysicsBullet* trackedWorld = NULL;
+}
+
+// blocks of finished threads are kept, their counts still belong to the run
+std::vector<Counters::Block*>& Counters::blocks ()
+{
+    static std::vector<Counters::Block*> b;
+    return b;
+}
+
+int Counters::id (const std::string& name)
+{
+    std::lock_guard<std::mutex> lock (mutex);
+    for (unsigned int i = 0; i < counterNames.size(); i++)
+	if (counterNames[i] == name)
+	    return i;
+
+    if (counterNames.size() == (size_t) maxCounters)
+    {
+	std::cerr << "Counters : more than " << maxCounters << " counters, " << name << " is merged into the last one" << std::endl;
+	return maxCounters - 1;
+    }
+    counterNames.push_back(name);
+
+    return counterNames.size() - 1;
+}
+
+std::vector<std::string> Counters::names ()
+{
+    std::lock_guard<std::mutex> lock (mutex);
+    return counterNames;
+}
+
+std::vector<uint64_t> Counters::totals ()
+{
+    std::lock_guard<std::mutex> lock (mutex);
+    std::vector<uint64_t> result (counterNames.size(), 0);
+    for (Block* b : blocks())
+	for (unsigned int i = 0; i < result.size(); i++)
+	    result[i] += b->values[i].load(std::memory_order_relaxed);
+
+    return result;
+}
+
+Counters::Block* Counters::newBlock ()
+{
+    Block* b = new Block;
+    for (int i = 0; i < maxCounters; i++)
+	b->values[i].store(0, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock (mutex);
+    blocks().push_back(b);
+
+    return b;
+}
+
+void Counters::track (Object* object)
+{
+    trackedObjects.push_back(object);
+}
+
+const std::vector<Object*>& Counters::tracked ()
+{
+    return trackedObjects;
+}
+
+void Counters::world (PhysicsBullet* physics)
+{
+    trackedWorld = physics;
+}
+
+int Counters::contactPairs ()
+{
+    if (!trackedWorld)
+	return 0;
+
+    // one manifold per pair of overlapping bounding boxes, the pair is in
+    // contact when it holds points
+    btDispatcher* dispatcher = trackedWorld->dynamicsWorld->getDispatcher();
+    int pairs = 0;
+    for (int i = 0; i < dispatcher->getNumManifolds(); i++)
+	if (dispatcher->getManifoldByIndexInternal(i)->getNumContacts() > 0)
+	    pairs++;
+
+    return pairs;
+}
+
+void Counters::clear ()
+{
+    trackedObjects.clear();
+    trackedWorld = NULL;
+}
+
+CounterRecorder::CounterRecorder (const std::string& filename)
+{
+    path = filename;
+}
+
+void CounterRecorder::step ()
+{
+    Row row;
+    row.time = simulator->time;
+    row.active = 0;
+    for (Object* object : Counters::tracked())
+	if (object->body->isActive())
+	    row.active++;
+    row.asleep = Counters::tracked().size() - row.active;
+    row.contacts = Counters::contactPairs();
+
+    std::vector<uint64_t> totals = Counters::totals();
+    previous.resize(totals.size(), 0);
+    row.counts.resize(totals.size());
+    for (unsigned int i = 0; i < totals.size(); i++)
+    {
+	row.counts[i] = totals[i] - previous[i];
+	previous[i] = totals[i];
+    }
+    rows.push_back(row);
+}
+
+bool CounterRecorder::close ()
+{
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file)
+    {
+	std::cerr << "CounterRecorder : cannot write " << path << std::endl;
+	return false;
+    }
+
+    std::vector<std::string> names = Counters::names();
+    fprintf(file, "time,bodiesActive,bodiesAsleep,contactPairs");
+    for (const std::string& name : names)
+	fprintf(file, ",%s", name.c_str());
+    fprintf(file, "\n");
+
+    for (const Row& row : rows)
+    {
+	fprintf(file, "%g,%d,%d,%d", row.time, row.active, row.asleep, row.contacts);
+	for (unsigned int i = 0; i < names.size(); i++)
+	    fprintf(file, ",%llu", i < row.counts.size() ? (unsigned long long) row.counts[i] : 0ULL);
+	fprintf(file, "\n");
+    }
+    rows.clear();
+
+    if (fclose(file) != 0)
+    {
+	std::cerr << "CounterRecorder : error while writing " << path << std::endl;
+	return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,119 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#ifndef COUNTERS_H
+#define COUNTERS_H
+
+#include "Service.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Object;
+class PhysicsBullet;
+
+// Usage, in hot paths : COUNT("optical.sent"); or COUNT_N("name", n);
+// The name is looked up once per call site.
+#define COUNT(name) COUNT_N(name, 1)
+#define COUNT_N(name, n) \
+    do { static const int counterId = Counters::id(name); Counters::add(counterId, n); } while (0)
+
+// Event counters of the simulation (messages, e-sense solves, docking...).
+// Optical messages are counted where controllers see them : sent, received
+// and read, or dropped unread (flushed inboxes). Losses inside the
+// transceiver (range, occlusion) happen in the library and are not counted.
+// Every thread increments its own copy, CounterRecorder sums them at the
+// end of each step.
+class Counters
+{
+public :
+    static const int maxCounters = 64;
+
+    static int id (const std::string& name);
+    static std::vector<std::string> names ();
+    static std::vector<uint64_t> totals ();
+
+    static inline void add (int id, uint64_t n)
+    {
+	// only the owner thread writes, relaxed is enough for the sum
+	std::atomic<uint64_t>& v = block()->values[id];
+	v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    // bodies counted as active or asleep at every step
+    static void track (Object* object);
+    static const std::vector<Object*>& tracked ();
+
+    // world whose pairs of bodies in contact are counted at every step
+    static void world (PhysicsBullet* physics);
+    static int contactPairs ();
+
+    // forgets the bodies and the world of a deleted experiment, the
+    // counts go on
+    static void clear ();
+
+private :
+    struct Block
+    {
+	std::atomic<uint64_t> values[maxCounters];
+    };
+
+    static Block* block ()
+    {
+	static thread_local Block* b = NULL;
+	if (!b)
+	    b = newBlock();
+	return b;
+    }
+    static Block* newBlock ();
+    static std::vector<Block*>& blocks ();
+};
+
+// Service writing the counters of every step to a CSV file, given on the
+// command line : time, active and asleep bodies, contact pairs, then one
+// column per counter
+class CounterRecorder : public Service
+{
+public :
+    CounterRecorder (const std::string& filename);
+
+    void step ();
+    bool close ();
+
+private :
+    std::string path;
+    std::vector<uint64_t> previous;
+
+    // counters appear as their call sites are reached, rows are written
+    // at the end once all columns are known
+    struct Row
+    {
+	float time;
+	int active;
+	int asleep;
+	int contacts;
+	std::vector<uint64_t> counts;
+    };
+    std::vector<Row> rows;
+};
+
+
+#endif
@@ -0,0 +1,89 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#include "FastReset.h"
+#include "Counters.h"
+
+#include "Simulator.h"
+#include "PhysicsBullet.h"
+#include "aFish.h"
+#include "aPad.h"
+
+
+void FastReset::time (Simulator* simulator)
+{
+    simulator->time = 0.0;
+}
+
+void FastReset::body (PhysicsBullet* physics, Object* object)
+{
+    // motion and forces left over from a previous run, the transform is
+    // set by the experiment
+    btRigidBody* body = object->body;
+    body->setLinearVelocity(btVector3(0,0,0));
+    body->setAngularVelocity(btVector3(0,0,0));
+    body->setInterpolationLinearVelocity(btVector3(0,0,0));
+    body->setInterpolationAngularVelocity(btVector3(0,0,0));
+    body->clearForces();
+    body->activate(true);
+
+    contacts(physics, object);
+}
+
+void FastReset::contacts (PhysicsBullet* physics, Object* object)
+{
+    // contact points and their warm-start impulses would carry over to the
+    // next run, the pairs are found again by the broadphase
+    btRigidBody* body = object->body;
+    btBroadphaseProxy* proxy = body->getBroadphaseHandle();
+    if (!proxy)
+	return;
+
+    btDispatcher* dispatcher = physics->dynamicsWorld->getDispatcher();
+    for (int i = 0; i < dispatcher->getNumManifolds(); i++)
+    {
+	btPersistentManifold* manifold = dispatcher->getManifoldByIndexInternal(i);
+	if (manifold->getBody0() == body || manifold->getBody1() == body)
+	    manifold->clearManifold();
+    }
+
+    physics->dynamicsWorld->getBroadphase()->getOverlappingPairCache()->cleanProxyFromPairs(proxy, dispatcher);
+}
+
+void FastReset::inbox (aFish* fish)
+{
+    // drop messages still pending in the optical receiver
+    DeviceOpticalTransceiver::Message msg;
+    while (fish->optical->receive(msg))
+	COUNT("optical.dropped");
+}
+
+void FastReset::propellers (aFish* fish)
+{
+    // set points of the previous run, until the controller gives new ones
+    fish->propellerLeft->setSpeed(0);
+    fish->propellerRight->setSpeed(0);
+}
+
+void FastReset::propellers (aPad* pad)
+{
+    pad->propellerLeft->setSpeed(0);
+    pad->propellerRight->setSpeed(0);
+    pad->propellerCentral->setSpeed(0);
+}
@@ -0,0 +1,59 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#ifndef FAST_RESET_H
+#define FAST_RESET_H
+
+#include "Object.h"
+
+class Simulator;
+class PhysicsBullet;
+class aFish;
+class aPad;
+
+// Brings a world back to its initial dynamic state, so that the next
+// replicate reuses it instead of rebuilding simulator, physics and meshes.
+// Experiments call these from reset(), next to the new positions.
+//
+// Left over : the e-sense currents of the last solve, until the next one,
+// and the clock of the water volume, which follows its own steps and not
+// the simulator time.
+class FastReset
+{
+public :
+    static void time (Simulator* simulator);
+    static void body (PhysicsBullet* physics, Object* object);
+    static void contacts (PhysicsBullet* physics, Object* object);
+    static void inbox (aFish* fish);
+    static void propellers (aFish* fish);
+    static void propellers (aPad* pad);
+
+    // body and controllers of the type the experiment gave the object,
+    // controllers of other types are left as they are
+    template <class C> static void object (PhysicsBullet* physics, Object* object)
+    {
+	body(physics, object);
+	for (auto* c : object->controllers)
+	    if (C* controller = dynamic_cast<C*> (c))
+		controller->reset();
+    }
+};
+
+
+#endif
@@ -0,0 +1,357 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+// nothing is rendered in headless mode
+#ifndef HEADLESS
+
+#include "InstancedRender.h"
+#include "Appearance.h"
+#include "TripleBuffer.h"
+
+#include "Simulator.h"
+#include "Object.h"
+#include "RenderOSG.h"
+
+#include <osg/Geode>
+#include <osg/Geometry>
+#include <osg/LOD>
+#include <osg/Program>
+#include <osg/TriangleIndexFunctor>
+#include <osg/VertexAttribDivisor>
+#include <osgDB/ReadFile>
+
+#include <iostream>
+#include <map>
+#include <vector>
+
+bool InstancedRender::enabled = false;
+bool InstancedRender::decoupled = false;
+
+// attribute locations of the per object arrays, above the ones OSG aliases
+static const int rowAttribute = 6;
+static const int colorAttribute = 9;
+
+static const char* vertexShader =
+    "#version 120\n"
+    "attribute vec4 row0;\n"
+    "attribute vec4 row1;\n"
+    "attribute vec4 row2;\n"
+    "attribute vec4 color;\n"
+    "varying vec3 normal;\n"
+    "varying vec4 objectColor;\n"
+    "void main ()\n"
+    "{\n"
+    "    vec3 p = vec3(dot(row0, gl_Vertex), dot(row1, gl_Vertex), dot(row2, gl_Vertex));\n"
+    "    vec3 n = vec3(dot(row0.xyz, gl_Normal), dot(row1.xyz, gl_Normal), dot(row2.xyz, gl_Normal));\n"
+    "    gl_Position = gl_ModelViewProjectionMatrix * vec4(p, 1.0);\n"
+    "    normal = normalize(gl_NormalMatrix * n);\n"
+    "    objectColor = color;\n"
+    "}\n";
+
+static const char* fragmentShader =
+    "#version 120\n"
+    "varying vec3 normal;\n"
+    "varying vec4 objectColor;\n"
+    "void main ()\n"
+    "{\n"
+    "    float light = 0.3 + 0.7 * abs(normalize(normal).z);\n"
+    "    gl_FragColor = vec4(objectColor.rgb * light, objectColor.a);\n"
+    "}\n";
+
+
+// triangles of a model, with the transforms of the model applied
+class TriangleCollector : public osg::NodeVisitor
+{
+public :
+    osg::ref_ptr<osg::Vec3Array> vertices;
+    osg::ref_ptr<osg::Vec3Array> normals;
+
+    TriangleCollector () : osg::NodeVisitor (osg::NodeVisitor::TRAVERSE_ALL_CHILDREN)
+    {
+	vertices = new osg::Vec3Array ();
+	normals = new osg::Vec3Array ();
+	matrices.push_back(osg::Matrix::identity());
+    }
+
+    void apply (osg::Transform& transform)
+    {
+	osg::Matrix m = matrices.back();
+	transform.computeLocalToWorldMatrix(m, this);
+	matrices.push_back(m);
+	traverse(transform);
+	matrices.pop_back();
+    }
+
+    // whole model only, not its simplified levels
+    void apply (osg::LOD& lod)
+    {
+	if (lod.getNumChildren() > 0)
+	    lod.getChild(0)->accept(*this);
+    }
+
+    void apply (osg::Geode& geode)
+    {
+	for (unsigned int i = 0; i < geode.getNumDrawables(); i++)
+	{
+	    osg::Geometry* geometry = geode.getDrawable(i)->asGeometry();
+	    osg::Vec3Array* v = geometry ? dynamic_cast<osg::Vec3Array*>(geometry->getVertexArray()) : NULL;
+	    if (!v)
+		continue;
+
+	    // vertex normals when the model has them, face normals otherwise
+	    osg::Vec3Array* n = dynamic_cast<osg::Vec3Array*>(geometry->getNormalArray());
+	    if (n && (geometry->getNormalBinding() != osg::Geometry::BIND_PER_VERTEX || n->size() != v->size()))
+		n = NULL;
+
+	    osg::TriangleIndexFunctor<Triangle> triangles;
+	    triangles.collector = this;
+	    triangles.v = v;
+	    triangles.n = n;
+	    geometry->accept(triangles);
+	}
+    }
+
+private :
+    std::vector<osg::Matrix> matrices;
+
+    struct Triangle
+    {
+	TriangleCollector* collector;
+	osg::Vec3Array* v;
+	osg::Vec3Array* n;
+
+	void operator() (unsigned int i1, unsigned int i2, unsigned int i3)
+	{
+	    const osg::Matrix& m = collector->matrices.back();
+	    osg::Vec3 a = (*v)[i1] * m, b = (*v)[i2] * m, c = (*v)[i3] * m;
+	    osg::Vec3 face = (b - a) ^ (c - a);
+	    face.normalize();
+
+	    collector->vertices->push_back(a);
+	    collector->vertices->push_back(b);
+	    collector->vertices->push_back(c);
+	    for (unsigned int i : {i1, i2, i3})
+	    {
+		osg::Vec3 normal = n ? osg::Matrix::transform3x3((*n)[i], m) : face;
+		normal.normalize();
+		collector->normals->push_back(normal);
+	    }
+	}
+    };
+};
+
+// all the objects showing one model, in one instanced draw call
+class InstancedModel : public osg::Geode
+{
+public :
+    InstancedModel (RenderOSG* render, osg::Node* model) : render (render)
+    {
+	TriangleCollector collector;
+	model->accept(collector);
+	radius = model->getBound().radius();
+
+	geometry = new osg::Geometry ();
+	geometry->setUseDisplayList(false);
+	geometry->setUseVertexBufferObjects(true);
+	geometry->setVertexArray(collector.vertices.get());
+	geometry->setNormalArray(collector.normals.get(), osg::Array::BIND_PER_VERTEX);
+
+	osg::StateSet* state = geometry->getOrCreateStateSet();
+	osg::Program* program = new osg::Program ();
+	program->addShader(new osg::Shader (osg::Shader::VERTEX, vertexShader));
+	program->addShader(new osg::Shader (osg::Shader::FRAGMENT, fragmentShader));
+	for (int k = 0; k < 3; k++)
+	{
+	    rows[k] = new osg::Vec4Array ();
+	    geometry->setVertexAttribArray(rowAttribute + k, rows[k].get(), osg::Array::BIND_PER_VERTEX);
+	    program->addBindAttribLocation("row" + std::to_string(k), rowAttribute + k);
+	    state->setAttribute(new osg::VertexAttribDivisor (rowAttribute + k, 1));
+	}
+	colors = new osg::Vec4Array ();
+	geometry->setVertexAttribArray(colorAttribute, colors.get(), osg::Array::BIND_PER_VERTEX);
+	program->addBindAttribLocation("color", colorAttribute);
+	state->setAttribute(new osg::VertexAttribDivisor (colorAttribute, 1));
+	state->setAttributeAndModes(program);
+
+	draw = new osg::DrawArrays (GL_TRIANGLES, 0, collector.vertices->size(), 0);
+	geometry->addPrimitiveSet(draw.get());
+	addDrawable(geometry.get());
+
+	setUpdateCallback(new Update ());
+    }
+
+    // Object alone would name osg::Object in here
+    void add (::Object* object)
+    {
+	objects.push_back(object);
+    }
+
+    // simulation thread, when decoupled
+    void publish ()
+    {
+	sample(snapshots.back());
+	snapshots.publish();
+    }
+
+    // arrays filled from the bodies or the latest snapshot, the bound
+    // covers every copy
+    void update ()
+    {
+	const std::vector<float>* state = &current;
+	if (InstancedRender::decoupled)
+	{
+	    snapshots.acquire();
+	    state = &snapshots.front();
+	    // the simulation thread steps, the render must not
+	    render->setPaused(true);
+	}
+	else
+	    sample(current);
+
+	unsigned int n = state->size() / stride;
+	for (int k = 0; k < 3; k++)
+	    rows[k]->resize(n);
+	colors->resize(n);
+
+	osg::BoundingBox box;
+	for (unsigned int i = 0; i < n; i++)
+	{
+	    const float* s = state->data() + i * stride;
+	    for (int k = 0; k < 3; k++)
+		(*rows[k])[i].set(s[4 * k], s[4 * k + 1], s[4 * k + 2], s[4 * k + 3]);
+	    (*colors)[i].set(s[12], s[13], s[14], s[15]);
+
+	    box.expandBy(osg::BoundingSphere (osg::Vec3 (s[3], s[7], s[11]), radius));
+	}
+
+	for (int k = 0; k < 3; k++)
+	    rows[k]->dirty();
+	colors->dirty();
+	draw->setNumInstances(n);
+
+	geometry->setInitialBound(box);
+	geometry->dirtyBound();
+	dirtyBound();
+    }
+
+private :
+    struct Update : public osg::NodeCallback
+    {
+	void operator() (osg::Node* node, osg::NodeVisitor* nv)
+	{
+	    static_cast<InstancedModel*>(node)->update();
+	    traverse(node, nv);
+	}
+    };
+
+    // per object : the three rows of the transform, then the colour
+    static const int stride = 16;
+
+    RenderOSG* render;
+    std::vector< ::Object*> objects;
+    float radius;
+
+    std::vector<float> current;
+    TripleBuffer<std::vector<float> > snapshots;
+
+    osg::ref_ptr<osg::Geometry> geometry;
+    osg::ref_ptr<osg::DrawArrays> draw;
+    osg::ref_ptr<osg::Vec4Array> rows[3];
+    osg::ref_ptr<osg::Vec4Array> colors;
+
+    void sample (std::vector<float>& state)
+    {
+	state.resize(objects.size() * stride);
+	for (unsigned int i = 0; i < objects.size(); i++)
+	{
+	    float* s = state.data() + i * stride;
+
+	    btScalar m[16];
+	    objects[i]->body->getCenterOfMassTransform().getOpenGLMatrix(m);
+	    for (int k = 0; k < 3; k++)
+		for (int c = 0; c < 4; c++)
+		    s[4 * k + c] = m[4 * c + k];
+
+	    const Appearance::Look& look = Appearance::get(objects[i]);
+	    for (int c = 0; c < 4; c++)
+		s[12 + c] = look.color[c];
+	}
+    }
+};
+
+static std::map<std::pair<RenderOSG*, std::string>, osg::ref_ptr<InstancedModel> > models;
+
+// publishes the snapshots of every model at the end of each step
+class InstancedPublisher : public Service
+{
+public :
+    void step ()
+    {
+	for (auto& m : models)
+	    m.second->publish();
+    }
+};
+
+
+void InstancedRender::add (RenderOSG* render, Object* object, const std::string& model)
+{
+    if (!enabled)
+    {
+	object->setMeshFilename(model);
+	object->registerService(render);
+	return;
+    }
+
+    osg::ref_ptr<InstancedModel>& instanced = models[std::make_pair(render, model)];
+    if (!instanced.valid())
+    {
+	osg::ref_ptr<osg::Node> node = osgDB::readRefNodeFile(model);
+	osg::Group* root = render->viewer->getSceneData() ? render->viewer->getSceneData()->asGroup() : NULL;
+	if (!node.valid() || !root)
+	{
+	    std::cerr << "InstancedRender : cannot draw " << model << ", objects get their own node" << std::endl;
+	    models.erase(std::make_pair(render, model));
+	    object->setMeshFilename(model);
+	    object->registerService(render);
+	    return;
+	}
+
+	instanced = new InstancedModel (render, node.get());
+	root->addChild(instanced.get());
+    }
+
+    instanced->add(object);
+}
+
+void InstancedRender::decouple (Simulator* simulator)
+{
+    // added last, so stepped after physics ; fixed 20 Hz of simulated time,
+    // which is the physics step of all the experiments (see the header)
+    InstancedPublisher* publisher = new InstancedPublisher ();
+    publisher->setTimestep(0.05);
+    simulator->add(publisher);
+}
+
+void InstancedRender::show (RenderOSG* render)
+{
+    render->setPaused(true);
+    render->run();
+}
+
+#endif
@@ -0,0 +1,59 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#ifndef INSTANCED_RENDER_H
+#define INSTANCED_RENDER_H
+
+#include <string>
+
+class Object;
+class RenderOSG;
+class Simulator;
+
+// Models of the objects shown by the render service. By default every
+// object loads the model and gets its own node (Object::setMeshFilename).
+// With instancing, all the objects sharing a model are drawn by a single
+// instanced draw call : the model is stored once and a vertex shader places
+// each copy from per object transform and colour arrays, refreshed once per
+// frame from the bodies and Appearance. Texts and device drawables of these
+// objects are not shown.
+//
+// Decoupled, the simulation runs on its own thread and publishes a snapshot
+// of these arrays every 0.05 s of simulated time, i.e. at 20 Hz of simulated
+// time (TripleBuffer) ; the render thread only ever reads the latest
+// snapshot, it never touches the bodies nor steps the simulator. The rate is
+// fixed : it matches the physics step of all the experiments, a shorter
+// step would be shown at 20 Hz only.
+class InstancedRender
+{
+public :
+    // set with --instanced and --decoupled
+    static bool enabled;
+    static bool decoupled;
+
+    static void add (RenderOSG* render, Object* object, const std::string& model);
+
+    // snapshots published by the simulator, then the render loop of the
+    // calling thread
+    static void decouple (Simulator* simulator);
+    static void show (RenderOSG* render);
+};
+
+
+#endif
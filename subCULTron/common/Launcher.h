@@ -0,0 +1,659 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#ifndef LAUNCHER_H
+#define LAUNCHER_H
+
+#include "Simulator.h"
+#include "Parameters.h"
+#include "ProcessPool.h"
+#include "Optimizer.h"
+#include "Sweep.h"
+#include "Snapshot.h"
+#include "TrajectoryRecorder.h"
+#include "TrajectoryPlayer.h"
+#include "Log.h"
+#include "Profiler.h"
+#include "Counters.h"
+#include "Interrupt.h"
+#include "Appearance.h"
+#include "StopCriterion.h"
+#ifndef HEADLESS
+#include "AssetCache.h"
+#include "InstancedRender.h"
+#include "LevelOfDetail.h"
+#include "VideoExport.h"
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include <sys/resource.h>
+#include <sys/time.h>
+
+#include <gsl/gsl_rng.h>
+extern gsl_rng* rng;
+extern long int rngSeed;
+
+// Command line front end shared by all experiments. Without options the
+// experiment is built with graphics and run, as it always was. Experiments
+// only need a constructor (Simulator*, bool graphics), reset() and run().
+
+// delete the world of an experiment, with the bindings that pointed into it
+inline void release (Simulator* simulator)
+{
+    delete simulator;
+    Parameters::clear();
+    Snapshot::clear();
+    Counters::clear();
+    Appearance::clear();
+}
+
+// build and run one headless replicate in the current process, returns the
+// requested measures ("time" is the simulated time reached) ; with
+// stopEarly, experiments binding earlyStop end once their criteria are met
+template <class E>
+std::vector<float> runReplicate (const std::vector<std::string>& measures, long int seed, bool stopEarly = false)
+{
+    Parameters::clear();
+    Snapshot::clear();
+    Counters::clear();
+    Appearance::clear();
+    rngSeed = seed;
+
+    Simulator* simulator = new Simulator ();
+    E* exp = new E (simulator, false);
+    Parameters::measure("time", [simulator] () { return simulator->time; });
+    if (stopEarly && Parameters::has("earlyStop"))
+	Parameters::set("earlyStop", 1);
+
+    // start again from a known random state
+    if (seed != 0)
+    {
+	gsl_rng_set(rng, seed);
+	exp->reset();
+    }
+    exp->run();
+
+    std::vector<float> values;
+    for (const std::string& m : measures)
+	values.push_back(Parameters::getMeasure(m));
+    release(simulator);
+
+    return values;
+}
+
+// values given (e.g. with --set) that no field of the experiment is bound
+// to, each is reported ; the registry must be filled already
+inline bool boundValues (const char* who)
+{
+    bool ok = true;
+    for (const std::string& n : Parameters::unbound())
+    {
+	std::cerr << who << " : unknown parameter " << n << std::endl;
+	ok = false;
+    }
+    return ok;
+}
+
+// names given by a design file that no field or measure of the experiment
+// is bound to, each is reported ; the registry must be filled already
+inline bool knownNames (const char* who, const std::vector<std::string>& names, const std::vector<std::string>& measures)
+{
+    bool ok = boundValues(who);
+    for (const std::string& n : names)
+	if (!Parameters::has(n))
+	{
+	    std::cerr << who << " : unknown parameter " << n << std::endl;
+	    ok = false;
+	}
+    for (const std::string& m : measures)
+	if (!Parameters::hasMeasure(m))
+	{
+	    std::cerr << who << " : unknown measure " << m << std::endl;
+	    ok = false;
+	}
+    return ok;
+}
+
+// build the experiment once to check the names of a design before any run
+// is started, the random state is left as it was
+template <class E>
+bool checkNames (const char* who, const std::vector<std::string>& names, const std::vector<std::string>& measures)
+{
+    // there is no generator yet before the first experiment is built
+    std::vector<char> state;
+    if (rng)
+	state.assign((char*) gsl_rng_state(rng), (char*) gsl_rng_state(rng) + gsl_rng_size(rng));
+
+    Parameters::clear();
+    Snapshot::clear();
+    Counters::clear();
+    Appearance::clear();
+    Simulator* simulator = new Simulator ();
+    new E (simulator, false);
+    Parameters::measure("time", [simulator] () { return simulator->time; });
+
+    bool ok = knownNames(who, names, measures);
+    release(simulator);
+
+    if (!state.empty())
+	std::copy(state.begin(), state.end(), (char*) gsl_rng_state(rng));
+    return ok;
+}
+
+template <class E>
+int optimize (const std::string& filename, int workers, long int seed)
+{
+    Optimizer optimizer (seed);
+    if (!optimizer.load(filename))
+	return 1;
+
+    std::vector<std::string> names = optimizer.names;
+    std::string measure = optimizer.measure;
+    if (!checkNames<E> ("Optimizer", names, std::vector<std::string> (1, measure)))
+	return 1;
+
+    // evaluations stop early, unless earlyStop is given
+    bool stopEarly = !Parameters::given("earlyStop");
+    Optimizer::Evaluation evaluation = [names, measure, stopEarly] (const std::vector<float>& genome, long int s) {
+	for (unsigned int i = 0; i < names.size(); i++)
+	    Parameters::set(names[i], genome[i]);
+	return runReplicate<E> (std::vector<std::string> (1, measure), s, stopEarly)[0];
+    };
+
+    ProcessPool pool (workers);
+    optimizer.run(evaluation, pool);
+
+    Optimizer::Individual best = optimizer.best();
+    std::cout << "Best fitness " << best.fitness << std::endl;
+    for (unsigned int i = 0; i < best.genome.size(); i++)
+	std::cout << "    --set " << names[i] << "=" << best.genome[i] << std::endl;
+
+    return 0;
+}
+
+// continue an experiment already built in this process, parameters are
+// changed in place and the run goes on from the current state
+template <class E>
+std::vector<float> runBranch (E* exp, const std::vector<std::string>& measures, long int seed)
+{
+    // criteria restart with the branch, the warm-up did not check them
+    gsl_rng_set(rng, seed);
+    StopCriteria::resetAll();
+    exp->run();
+
+    std::vector<float> values;
+    for (const std::string& m : measures)
+	values.push_back(Parameters::getMeasure(m));
+
+    return values;
+}
+
+template <class E>
+int sweep (const std::string& filename, int workers)
+{
+    Sweep design;
+    if (!design.load(filename))
+	return 1;
+
+    std::vector<std::string> names = design.names();
+    std::vector<std::string> measures = design.measures;
+    if (design.warmup <= 0 && !checkNames<E> ("Sweep", names, measures))
+	return 1;
+
+    // runs stop early, unless earlyStop is given
+    bool stopEarly = !Parameters::given("earlyStop");
+    Sweep::Run run = [names, measures, stopEarly] (const std::vector<float>& point, long int s) {
+	for (unsigned int i = 0; i < names.size(); i++)
+	    Parameters::set(names[i], point[i]);
+	return runReplicate<E> (measures, s, stopEarly);
+    };
+
+    // warm up once, runs are then forked from this process
+    Simulator* simulator = NULL;
+    if (design.warmup > 0)
+    {
+	Parameters::clear();
+	Snapshot::clear();
+	Counters::clear();
+	Appearance::clear();
+
+	simulator = new Simulator ();
+	E* exp = new E (simulator, false);
+	Parameters::measure("time", [simulator] () { return simulator->time; });
+
+	if (!knownNames("Sweep", names, measures))
+	{
+	    release(simulator);
+	    return 1;
+	}
+	if (!Parameters::has("maxTime"))
+	{
+	    std::cerr << "Sweep : warmup needs a maxTime parameter" << std::endl;
+	    release(simulator);
+	    return 1;
+	}
+	// the warm-up is a common prefix, it must not stop early
+	float maxTime = Parameters::get("maxTime");
+	float earlyStop = Parameters::has("earlyStop") ? Parameters::get("earlyStop") : NAN;
+	Parameters::set("maxTime", design.warmup);
+	if (!std::isnan(earlyStop))
+	    Parameters::set("earlyStop", 0);
+	exp->run();
+	Parameters::set("maxTime", maxTime);
+	if (!std::isnan(earlyStop))
+	    Parameters::set("earlyStop", stopEarly ? 1 : earlyStop);
+
+	std::cout << "Sweep : warmed up to time " << simulator->time << std::endl;
+
+	run = [exp, names, measures] (const std::vector<float>& point, long int s) {
+	    for (unsigned int i = 0; i < names.size(); i++)
+		Parameters::set(names[i], point[i]);
+	    return runBranch<E> (exp, measures, s);
+	};
+    }
+
+    ProcessPool pool (workers);
+    bool ok = design.run(run, pool);
+
+    if (simulator)
+	release(simulator);
+
+    return ok ? 0 : 1;
+}
+
+// several headless replicates with the same world : only its dynamic state
+// is reset between them, one line of measures per replicate
+template <class E>
+int replicate (int replicates, long int seed)
+{
+    if (seed == 0)
+	seed = 1;
+    rngSeed = seed;
+
+    Simulator* simulator = new Simulator ();
+    E* exp = new E (simulator, false);
+    Parameters::measure("time", [simulator] () { return simulator->time; });
+    if (!boundValues("Replicate"))
+    {
+	release(simulator);
+	return 1;
+    }
+
+    std::vector<std::string> measures = Parameters::measureNames();
+    std::cout << "replicate,seed,resetTime";
+    for (const std::string& m : measures)
+	std::cout << "," << m;
+    std::cout << std::endl;
+
+    for (int k = 0; k < replicates; k++)
+    {
+	timeval start, end;
+	gettimeofday(&start, NULL);
+	gsl_rng_set(rng, seed + k);
+	exp->reset();
+	gettimeofday(&end, NULL);
+
+	exp->run();
+
+	float resetTime = (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) * 1e-6;
+	std::cout << k << "," << seed + k << "," << resetTime;
+	for (const std::string& m : measures)
+	    std::cout << "," << Parameters::getMeasure(m);
+	std::cout << std::endl;
+    }
+
+    release(simulator);
+
+    return 0;
+}
+
+// populations multiplied by factor, the arena grows with them so that the
+// density stays the same
+inline void scalePopulations (float factor)
+{
+    const char* populations[] = {"aFishCount", "aFishActiveCount", "aPadCount", "aMusselCount"};
+    for (const char* name : populations)
+	Parameters::scale(name, factor);
+    Parameters::scale("aquariumRadius", sqrt(factor));
+}
+
+// headless run measuring its own cost, printed as one JSON line (see
+// benchmark.py)
+template <class E>
+int benchmark (long int seed, float scale)
+{
+    if (seed == 0)
+	seed = 1;
+    rngSeed = seed;
+    Profiler::enabled = true;
+
+    Simulator* simulator = new Simulator ();
+    E* exp = new Profiled<E> (simulator, false);
+    if (!boundValues("Benchmark"))
+    {
+	release(simulator);
+	return 1;
+    }
+
+    // the cost is measured over the whole maxTime
+    if (Parameters::has("earlyStop"))
+	Parameters::set("earlyStop", 0);
+    gsl_rng_set(rng, seed);
+    exp->reset();
+
+    timeval start, end;
+    gettimeofday(&start, NULL);
+    Profiler::start();
+    exp->run();
+    gettimeofday(&end, NULL);
+
+    double wall = (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) * 1e-6;
+    uint64_t steps = Profiler::calls("PhysicsBullet");
+    size_t agents = Counters::tracked().size();
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    std::cout << "{\"scale\": " << scale
+	      << ", \"seed\": " << seed
+	      << ", \"agents\": " << agents
+	      << ", \"simulatedTime\": " << simulator->time
+	      << ", \"wallTime\": " << wall
+	      << ", \"steps\": " << steps
+	      << ", \"stepsPerSecond\": " << (wall > 0 ? steps / wall : 0)
+	      << ", \"nsPerAgentStep\": " << (steps * agents > 0 ? wall * 1e9 / (steps * agents) : 0)
+	      << ", \"peakRssKB\": " << usage.ru_maxrss
+	      << ", \"phases\": {";
+    std::vector<std::string> names = Profiler::names();
+    for (unsigned int i = 0; i < names.size(); i++)
+	std::cout << (i ? ", " : "") << "\"" << names[i] << "\": " << Profiler::seconds(names[i]);
+    std::cout << "}}" << std::endl;
+
+    release(simulator);
+
+    return 0;
+}
+
+#ifndef HEADLESS
+// simulation on a thread of its own, run headless by the experiment, while
+// this thread shows the snapshots it publishes ; closing the window ends the
+// run at the current time
+template <class E>
+void runDecoupled (E* exp, Simulator* simulator)
+{
+    RenderOSG* render = exp->render;
+    exp->render = NULL;
+    InstancedRender::decouple(simulator);
+
+    Interrupt::clear();
+    std::thread simulation ([exp] () { exp->run(); });
+    InstancedRender::show(render);
+
+    Interrupt::request();
+    simulation.join();
+
+    exp->render = render;
+}
+#endif
+
+template <class E>
+int launch (int argc, char** argv)
+{
+    namespace po = boost::program_options;
+
+    po::options_description options ("Options");
+    options.add_options()
+	("help,h", "print this help")
+	("headless,n", "run without graphics")
+	("seed,s", po::value<long int>()->default_value(0), "random seed, 0 keeps the default seeding")
+	("set", po::value<std::vector<std::string> >(), "override a parameter, as name=value")
+	("optimize", po::value<std::string>(), "optimise parameters as described in the given file")
+	("sweep", po::value<std::string>(), "run the parameter sweep described in the given file")
+	("workers,j", po::value<int>()->default_value(0), "worker processes, 0 uses all cores")
+	("snapshot", po::value<std::string>(), "save the state reached at the end of the run (see maxTime), for inspection")
+	("replicates,r", po::value<int>()->default_value(1), "headless replicates run in the same world, reset in place")
+	("record", po::value<std::string>(), "record trajectories to the given file, sampled every recordPeriod")
+	("replay", po::value<std::string>(), "show a recorded run, given the parameters it was recorded with")
+	("seek", po::value<float>(), "start the replay at the given time")
+	("speed", po::value<float>()->default_value(1.0), "replay speed, changed with + and - during the replay")
+	("log", po::value<std::string>(), "write controller messages to the given file instead of the console")
+	("log-level", po::value<int>(), "0 errors, 1 warnings, 2 information, 3 debug messages of the agents with dbg set")
+	("profile", "print the time spent per service and controller class at the end of the run")
+	("profile-trace", po::value<std::string>(), "also write every measured call to the given Chrome trace / Perfetto file")
+	("counters", po::value<std::string>(), "write event counters (messages, e-sense solves, docking, active bodies, contact pairs) to the given CSV file")
+	("counters-period", po::value<float>()->default_value(0.05), "simulated time covered by each line of counters")
+	("benchmark", "headless run printing its cost (steps/s, ns per agent step, peak memory, phases) as JSON")
+	("scale", po::value<float>()->default_value(1.0), "population factor, the arena grows with it at constant density")
+	("mesh-cache", po::value<std::string>(), "directory of the binary models parsed by earlier runs, 'none' to always parse the originals")
+	("instanced", "draw the agents sharing a model in one instanced call, without their texts and device drawables")
+	("decoupled", "simulate at full speed on a thread of its own, the render shows its latest state (implies --instanced)")
+	("lod", po::value<int>()->default_value(2000), "models with more triangles get simplified levels for when they are small on screen, 0 keeps them whole")
+	("cull-pixels", po::value<float>()->default_value(2.0), "objects smaller than this on screen are not drawn, 0 draws them all")
+	("video", po::value<std::string>(), "render without window until maxTime, to a .y4m video or to numbered images (frames/%05d.png)")
+	("video-period", po::value<float>()->default_value(0.1), "simulated time between two video frames")
+	("video-size", po::value<std::string>()->default_value("1280x720"), "video frame size, as widthxheight")
+	("video-keep-all", "queue every frame until it is encoded, instead of dropping frames when the encoder falls behind");
+
+    po::variables_map vm;
+    try
+    {
+	po::store(po::parse_command_line(argc, argv, options), vm);
+	po::notify(vm);
+    }
+    catch (po::error& e)
+    {
+	std::cerr << e.what() << std::endl << options << std::endl;
+	return 1;
+    }
+
+    if (vm.count("help"))
+    {
+	std::cout << options << std::endl;
+	return 0;
+    }
+
+    if (vm.count("set"))
+	for (const std::string& s : vm["set"].as<std::vector<std::string> >())
+	    if (!Parameters::set(s))
+	    {
+		std::cerr << "Malformed parameter " << s << ", expected name=value" << std::endl;
+		return 1;
+	    }
+
+    if (vm.count("log-level"))
+	Log::level = vm["log-level"].as<int>();
+    if (vm.count("log") && !Log::open(vm["log"].as<std::string>()))
+	return 1;
+
+    float scale = vm["scale"].as<float>();
+    if (scale != 1.0)
+	scalePopulations(scale);
+
+    long int seed = vm["seed"].as<long int>();
+    int workers = vm["workers"].as<int>();
+    int replicates = vm["replicates"].as<int>();
+
+    if (vm.count("optimize"))
+	return optimize<E> (vm["optimize"].as<std::string>(), workers, seed);
+
+    if (vm.count("sweep"))
+	return sweep<E> (vm["sweep"].as<std::string>(), workers);
+
+    if (vm.count("benchmark"))
+	return benchmark<E> (seed, scale);
+
+    // recorders are created by the experiments, the first run is recorded
+    if (vm.count("record"))
+	TrajectoryRecorder::filename = vm["record"].as<std::string>();
+
+    if (replicates > 1)
+	return replicate<E> (replicates, seed);
+
+#ifdef HEADLESS
+    // built without render
+    bool graphics = false;
+#else
+    bool graphics = !vm.count("headless");
+#endif
+    if (vm.count("video") && (!graphics || vm.count("decoupled")))
+    {
+	std::cerr << "A video is rendered with graphics, not decoupled" << std::endl;
+	return 1;
+    }
+
+    if (vm.count("replay"))
+    {
+	if (!graphics || vm.count("record") || vm.count("decoupled"))
+	{
+	    std::cerr << "A replay is shown with graphics, without recording nor decoupling" << std::endl;
+	    return 1;
+	}
+
+	TrajectoryPlayer::replay = new TrajectoryPlayer ();
+	if (!TrajectoryPlayer::replay->open(vm["replay"].as<std::string>()))
+	    return 1;
+	TrajectoryPlayer::replay->setSpeed(vm["speed"].as<float>());
+	if (vm.count("seek"))
+	    TrajectoryPlayer::replay->seek(vm["seek"].as<float>());
+    }
+
+    Profiler::enabled = vm.count("profile") || vm.count("profile-trace");
+    if (vm.count("profile-trace"))
+	Profiler::traceFilename = vm["profile-trace"].as<std::string>();
+
+    // setup and run simulated experiment
+    if (seed != 0)
+	rngSeed = seed;
+
+#ifndef HEADLESS
+    // models are parsed once, whatever the number of objects using them
+    if (graphics)
+    {
+	if (vm.count("mesh-cache"))
+	    AssetCache::directory = vm["mesh-cache"].as<std::string>();
+	LevelOfDetail::triangles = vm["lod"].as<int>();
+	LevelOfDetail::cullPixels = vm["cull-pixels"].as<float>();
+	AssetCache::install();
+	InstancedRender::enabled = vm.count("instanced") || vm.count("decoupled");
+	InstancedRender::decoupled = vm.count("decoupled");
+    }
+#endif
+
+    Simulator* simulator = new Simulator ();
+
+    E* exp = new Profiled<E> (simulator, graphics);
+    if (!boundValues("Launcher"))
+    {
+	release(simulator);
+	return 1;
+    }
+    if (TrajectoryPlayer::replay)
+	TrajectoryPlayer::replay->attach(exp->render);
+#ifndef HEADLESS
+    // looks are shown once per frame, the decoupled render only uses the
+    // snapshots of the simulation thread
+    if (exp->render && !InstancedRender::decoupled)
+	Appearance::attach(exp->render);
+    if (exp->render)
+	LevelOfDetail::attach(exp->render);
+
+    VideoExport* video = NULL;
+    if (vm.count("video"))
+    {
+	video = new VideoExport (vm["video"].as<std::string>(), vm["video-period"].as<float>());
+	video->keepAll = vm.count("video-keep-all");
+	if (sscanf(vm["video-size"].as<std::string>().c_str(), "%dx%d", &video->width, &video->height) != 2
+	    || !video->attach(exp->render, simulator))
+	{
+	    std::cerr << "Cannot render the video" << std::endl;
+	    delete video;
+	    release(simulator);
+	    return 1;
+	}
+    }
+#endif
+
+    CounterRecorder* counters = NULL;
+    if (vm.count("counters"))
+    {
+	counters = new CounterRecorder (vm["counters"].as<std::string>());
+	counters->setTimestep(vm["counters-period"].as<float>());
+	simulator->add(counters);
+    }
+    if (vm.count("snapshot") && !Snapshot::available())
+    {
+	std::cerr << "This experiment does not support snapshots" << std::endl;
+	release(simulator);
+	return 1;
+    }
+
+    if (seed != 0)
+    {
+	gsl_rng_set(rng, seed);
+	exp->reset();
+    }
+
+    Profiler::start();
+#ifndef HEADLESS
+    if (InstancedRender::decoupled && exp->render)
+	runDecoupled(exp, simulator);
+    else
+#endif
+	exp->run();
+
+    int status = 0;
+#ifndef HEADLESS
+    if (video)
+    {
+	if (!video->close())
+	    status = 1;
+	delete video;
+    }
+#endif
+    if (counters && !counters->close())
+	status = 1;
+    // closed by the experiment already, the result is kept
+    if (exp->recorder && !exp->recorder->close())
+	status = 1;
+    if (Profiler::enabled)
+    {
+	Log::flush();
+	Profiler::report(std::cout);
+	if (!Profiler::traceFilename.empty() && !Profiler::writeTrace(Profiler::traceFilename))
+	    status = 1;
+    }
+    if (vm.count("snapshot") && !Snapshot::save(vm["snapshot"].as<std::string>()))
+	status = 1;
+
+    release(simulator);
+
+    return status;
+}
+
+
+#endif
@@ -0,0 +1,124 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+// nothing is rendered in headless mode
+#ifndef HEADLESS
+
+#include "LevelOfDetail.h"
+
+#include "RenderOSG.h"
+
+#include <osg/Camera>
+#include <osg/Geode>
+#include <osg/Geometry>
+#include <osg/LOD>
+#include <osg/TriangleIndexFunctor>
+#include <osgUtil/MeshOptimizers>
+#include <osgUtil/Simplifier>
+
+#include <cfloat>
+
+int LevelOfDetail::triangles = 2000;
+float LevelOfDetail::cullPixels = 2.0;
+
+// simplified levels : share of the triangles kept, and the size on screen
+// in pixels below which they are used
+static const int levelCount = 2;
+static const float levelRatios[levelCount] = {0.25, 0.05};
+static const float levelPixels[levelCount] = {300.0, 80.0};
+
+
+class TriangleCounter : public osg::NodeVisitor
+{
+public :
+    int count;
+
+    TriangleCounter () : osg::NodeVisitor (osg::NodeVisitor::TRAVERSE_ALL_CHILDREN)
+    {
+	count = 0;
+    }
+
+    void apply (osg::Geode& geode)
+    {
+	for (unsigned int i = 0; i < geode.getNumDrawables(); i++)
+	{
+	    osg::Geometry* geometry = geode.getDrawable(i)->asGeometry();
+	    if (!geometry)
+		continue;
+
+	    osg::TriangleIndexFunctor<Triangle> triangles;
+	    triangles.count = &count;
+	    geometry->accept(triangles);
+	}
+    }
+
+private :
+    struct Triangle
+    {
+	int* count;
+
+	void operator() (unsigned int, unsigned int, unsigned int)
+	{
+	    (*count)++;
+	}
+    };
+};
+
+
+osg::Node* LevelOfDetail::build (osg::Node* model)
+{
+    TriangleCounter counter;
+    model->accept(counter);
+    if (triangles <= 0 || counter.count <= triangles)
+	return model;
+
+    // whole model first, the instanced render draws that one
+    osg::LOD* lod = new osg::LOD ();
+    lod->setRangeMode(osg::LOD::PIXEL_SIZE_ON_SCREEN);
+    lod->addChild(model, levelPixels[0], FLT_MAX);
+
+    for (int k = 0; k < levelCount; k++)
+    {
+	osg::Node* level = osg::clone(model, osg::CopyOp::DEEP_COPY_ALL);
+
+	// shared vertices, so that edges can collapse
+	osgUtil::IndexMeshVisitor mesh;
+	level->accept(mesh);
+	mesh.makeMesh();
+
+	osgUtil::Simplifier simplifier (levelRatios[k]);
+	level->accept(simplifier);
+
+	lod->addChild(level, k + 1 < levelCount ? levelPixels[k + 1] : 0.0, levelPixels[k]);
+    }
+
+    return lod;
+}
+
+void LevelOfDetail::attach (RenderOSG* render)
+{
+    if (cullPixels <= 0.0)
+	return;
+
+    osg::Camera* camera = render->viewer->getCamera();
+    camera->setCullingMode(camera->getCullingMode() | osg::CullSettings::SMALL_FEATURE_CULLING);
+    camera->setSmallFeatureCullingPixelSize(cullPixels);
+}
+
+#endif
@@ -0,0 +1,44 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#ifndef LEVEL_OF_DETAIL_H
+#define LEVEL_OF_DETAIL_H
+
+namespace osg { class Node; }
+class RenderOSG;
+
+// Dense models are drawn with fewer triangles when they are small on screen.
+// Models read through AssetCache with more than `triangles` triangles are
+// simplified at load into two coarser levels, switched on their size in
+// pixels, and the levels go to the binary cache with the model. Objects
+// smaller than `cullPixels` on screen are not drawn at all.
+class LevelOfDetail
+{
+public :
+    // parameters, set from the command line
+    static int triangles;
+    static float cullPixels;
+
+    // methods
+    static osg::Node* build (osg::Node* model);
+    static void attach (RenderOSG* render);
+};
+
+
+#endif
@@ -0,0 +1,210 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#include "Log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#include <pthread.h>
+
+int Log::level = LOG_LEVEL;
+
+
+// bounded multi producer queue, each slot carries the sequence number
+// telling whether it is free or holds a message for the current lap
+namespace
+{
+    const unsigned int ringSize = 4096;
+    const unsigned int textSize = 248;
+
+    struct Slot
+    {
+	std::atomic<unsigned int> sequence;
+	unsigned short level;
+	unsigned short length;
+	char text[textSize];
+    };
+
+    struct Ring
+    {
+	Slot slots[ringSize];
+	std::atomic<unsigned int> head;
+	std::atomic<unsigned int> tail;
+	std::atomic<unsigned long> dropped;
+
+	Ring () : head (0), tail (0), dropped (0)
+	{
+	    for (unsigned int i = 0; i < ringSize; i++)
+		slots[i].sequence.store(i, std::memory_order_relaxed);
+	}
+    };
+
+    Ring ring;
+
+    // output side : one writer at a time, started with the first message
+    std::mutex drainMutex;
+    FILE* output = stdout;
+    std::thread* writer = NULL;
+    std::atomic<bool> running (false);
+    std::atomic<bool> stopping (false);
+
+    // workers are forked : the writer thread does not exist in the child,
+    // its handle is left alone and a new one starts with the next message
+    void forkPrepare () { drainMutex.lock(); }
+    void forkParent () { drainMutex.unlock(); }
+    void forkChild ()
+    {
+	drainMutex.unlock();
+	writer = NULL;
+	running.store(false);
+    }
+
+    // written at exit, after the experiments
+    struct Shutdown
+    {
+	Shutdown ()
+	{
+	    pthread_atfork(forkPrepare, forkParent, forkChild);
+	}
+
+	~Shutdown ()
+	{
+	    if (writer)
+	    {
+		stopping.store(true);
+		writer->join();
+	    }
+	    Log::flush();
+
+	    if (Log::dropped() > 0)
+		std::cerr << "Log : " << Log::dropped() << " messages dropped, the output could not keep up" << std::endl;
+	}
+    } shutdown;
+}
+
+bool Log::open (const std::string& filename)
+{
+    FILE* file = fopen(filename.c_str(), "w");
+    if (!file)
+    {
+	std::cerr << "Log : cannot write " << filename << std::endl;
+	return false;
+    }
+
+    flush();
+    std::lock_guard<std::mutex> lock (drainMutex);
+    if (output != stdout)
+	fclose(output);
+    output = file;
+
+    return true;
+}
+
+void Log::push (int level, const std::string& text)
+{
+    if (!running.load(std::memory_order_acquire))
+	start();
+
+    unsigned int pos = ring.head.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true)
+    {
+	slot = &ring.slots[pos % ringSize];
+	int diff = int(slot->sequence.load(std::memory_order_acquire) - pos);
+	if (diff == 0 && ring.head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+	    break;
+	if (diff < 0)
+	{
+	    ring.dropped.fetch_add(1, std::memory_order_relaxed);
+	    return;
+	}
+	if (diff > 0)
+	    pos = ring.head.load(std::memory_order_relaxed);
+    }
+
+    slot->level = level;
+    slot->length = std::min((unsigned int) text.size(), textSize);
+    memcpy(slot->text, text.data(), slot->length);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+}
+
+bool Log::drain ()
+{
+    std::lock_guard<std::mutex> lock (drainMutex);
+
+    bool any = false;
+    unsigned int pos = ring.tail.load(std::memory_order_relaxed);
+    while (true)
+    {
+	Slot* slot = &ring.slots[pos % ringSize];
+	if (slot->sequence.load(std::memory_order_acquire) != pos + 1)
+	    break;
+
+	// information and debug lines are printed as they were given
+	if (slot->level == LOG_ERROR)
+	    fputs("error : ", output);
+	else if (slot->level == LOG_WARNING)
+	    fputs("warning : ", output);
+	fwrite(slot->text, 1, slot->length, output);
+	fputc('\n', output);
+	slot->sequence.store(pos + ringSize, std::memory_order_release);
+	ring.tail.store(++pos, std::memory_order_relaxed);
+	any = true;
+    }
+    if (any)
+	fflush(output);
+
+    return any;
+}
+
+void Log::flush ()
+{
+    // buffered standard output first, to keep the order of both
+    std::cout.flush();
+    drain();
+}
+
+unsigned long Log::dropped ()
+{
+    return ring.dropped.load(std::memory_order_relaxed);
+}
+
+void Log::start ()
+{
+    static std::mutex startMutex;
+    std::lock_guard<std::mutex> lock (startMutex);
+    if (running.load())
+	return;
+
+    stopping.store(false);
+    writer = new std::thread (&Log::write);
+    running.store(true, std::memory_order_release);
+}
+
+void Log::write ()
+{
+    while (!stopping.load())
+	if (!drain())
+	    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+}
@@ -0,0 +1,92 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#ifndef LOG_H
+#define LOG_H
+
+#include <atomic>
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+#define LOG_ERROR 0
+#define LOG_WARNING 1
+#define LOG_INFO 2
+#define LOG_DEBUG 3
+
+// messages above LOG_LEVEL are compiled out, release builds keep up to info
+#ifndef LOG_LEVEL
+#ifdef NDEBUG
+#define LOG_LEVEL LOG_INFO
+#else
+#define LOG_LEVEL LOG_DEBUG
+#endif
+#endif
+
+// Usage : LOG(LOG_INFO) << "text " << value;
+// or, for the agents selected with their dbg flag : LOG_IF(LOG_DEBUG, dbg) << ...
+// The message is only formatted when it passes both the compile time and
+// the run time level (and the condition). Messages built in a loop use a
+// Log::Line under LOG_ENABLED.
+#define LOG_ENABLED(severity, condition) ((severity) <= LOG_LEVEL && (severity) <= Log::level && (condition))
+#define LOG(severity) LOG_IF(severity, true)
+// a loop run at most once rather than an if, so that an else after the
+// macro binds to the caller's if
+#define LOG_IF(severity, condition) for (bool logOnce = LOG_ENABLED(severity, condition); logOnce; logOnce = false) Log::Line (severity)
+
+// Messages are queued in a lock free ring and written by a background
+// thread, the simulation never waits for the console. When the ring is full
+// messages are dropped and counted rather than blocking.
+class Log
+{
+public :
+    // run time level, set from the command line
+    static int level;
+
+    static bool open (const std::string& filename);
+    static void flush ();
+    static unsigned long dropped ();
+
+    // one message, queued when it goes out of scope
+    class Line
+    {
+    public :
+	Line (int level) : level (level) {}
+	~Line () { Log::push(level, stream.str()); }
+
+	template <class T> Line& operator<< (const T& value)
+	{
+	    stream << value;
+	    return *this;
+	}
+
+    private :
+	int level;
+	std::ostringstream stream;
+    };
+
+private :
+    static void push (int level, const std::string& text);
+    static bool drain ();
+    static void start ();
+    static void write ();
+};
+
+
+#endif
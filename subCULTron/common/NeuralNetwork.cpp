@@ -0,0 +1,183 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#include "NeuralNetwork.h"
+
+#include <algorithm>
+#include <fstream>
+
+#include <gsl/gsl_rng.h>
+#include <gsl/gsl_randist.h>
+extern gsl_rng* rng;
+
+
+NeuralNetwork::NeuralNetwork ()
+{
+}
+
+NeuralNetwork::NeuralNetwork (const std::vector<int>& layers)
+{
+    setLayers(layers);
+}
+
+void NeuralNetwork::setLayers (const std::vector<int>& layers)
+{
+    this->layers = layers;
+
+    weights.clear();
+    biases.clear();
+    activations.clear();
+    for (unsigned int l = 1; l < layers.size(); l++)
+    {
+	weights.push_back(Eigen::MatrixXf::Zero(layers[l], layers[l-1]));
+	biases.push_back(Eigen::VectorXf::Zero(layers[l]));
+	activations.push_back(Eigen::MatrixXf());
+    }
+}
+
+void NeuralNetwork::resize (const std::vector<int>& layers)
+{
+    std::vector<Eigen::MatrixXf> w = weights;
+    std::vector<Eigen::VectorXf> b = biases;
+    setLayers(layers);
+
+    for (unsigned int l = 0; l < weights.size() && l < w.size(); l++)
+    {
+	int rows = std::min(weights[l].rows(), w[l].rows());
+	int cols = std::min(weights[l].cols(), w[l].cols());
+	weights[l].topLeftCorner(rows, cols) = w[l].topLeftCorner(rows, cols);
+	biases[l].head(rows) = b[l].head(rows);
+    }
+}
+
+int NeuralNetwork::inputCount ()
+{
+    return layers.empty() ? 0 : layers.front();
+}
+
+int NeuralNetwork::outputCount ()
+{
+    return layers.empty() ? 0 : layers.back();
+}
+
+void NeuralNetwork::forward (const Eigen::MatrixXf& inputs, Eigen::MatrixXf& outputs)
+{
+    const Eigen::MatrixXf* x = &inputs;
+
+    for (unsigned int l = 0; l < weights.size(); l++)
+    {
+	// one matrix product for all the agents of the batch
+	Eigen::MatrixXf& a = activations[l];
+	a.noalias() = weights[l] * (*x);
+	a.colwise() += biases[l];
+	a = a.array().tanh();
+	x = &a;
+    }
+
+    outputs = *x;
+}
+
+int NeuralNetwork::genomeSize ()
+{
+    int size = 0;
+    for (unsigned int l = 0; l < weights.size(); l++)
+	size += weights[l].size() + biases[l].size();
+    return size;
+}
+
+std::vector<float> NeuralNetwork::getGenome ()
+{
+    std::vector<float> genome;
+    genome.reserve(genomeSize());
+
+    for (unsigned int l = 0; l < weights.size(); l++)
+    {
+	genome.insert(genome.end(), weights[l].data(), weights[l].data() + weights[l].size());
+	genome.insert(genome.end(), biases[l].data(), biases[l].data() + biases[l].size());
+    }
+    return genome;
+}
+
+void NeuralNetwork::setGenome (const std::vector<float>& genome)
+{
+    if ((int) genome.size() != genomeSize())
+	return;
+
+    const float* g = genome.data();
+    for (unsigned int l = 0; l < weights.size(); l++)
+    {
+	std::copy(g, g + weights[l].size(), weights[l].data());
+	g += weights[l].size();
+	std::copy(g, g + biases[l].size(), biases[l].data());
+	g += biases[l].size();
+    }
+}
+
+void NeuralNetwork::randomize (float range)
+{
+    std::vector<float> genome (genomeSize());
+    for (unsigned int i = 0; i < genome.size(); i++)
+	genome[i] = gsl_ran_flat(rng, -range, range);
+    setGenome(genome);
+}
+
+bool NeuralNetwork::load (const std::string& filename)
+{
+    std::ifstream file (filename.c_str());
+    if (!file.good())
+	return false;
+
+    // first line : layer sizes
+    int count = 0;
+    file >> count;
+    std::vector<int> sizes (count);
+    for (int i = 0; i < count; i++)
+	file >> sizes[i];
+    setLayers(sizes);
+
+    // then all weights and biases
+    std::vector<float> genome (genomeSize());
+    for (unsigned int i = 0; i < genome.size(); i++)
+	file >> genome[i];
+
+    if (file.fail())
+	return false;
+
+    setGenome(genome);
+    return true;
+}
+
+bool NeuralNetwork::save (const std::string& filename)
+{
+    std::ofstream file (filename.c_str());
+    if (!file.good())
+	return false;
+
+    file << layers.size();
+    for (unsigned int i = 0; i < layers.size(); i++)
+	file << " " << layers[i];
+    file << std::endl;
+
+    std::vector<float> genome = getGenome();
+    file.precision(9);
+    for (unsigned int i = 0; i < genome.size(); i++)
+	file << genome[i] << (i + 1 < genome.size() ? " " : "\n");
+
+    return file.good();
+}
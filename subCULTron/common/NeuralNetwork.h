@@ -0,0 +1,64 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#ifndef NEURAL_NETWORK_H
+#define NEURAL_NETWORK_H
+
+#include <Eigen/Eigen>
+
+#include <string>
+#include <vector>
+
+// Multilayer perceptron with tanh activations. Inputs are given as a matrix
+// with one column per agent, so that a whole swarm is evaluated with one
+// matrix product per layer.
+class NeuralNetwork
+{
+public :
+    std::vector<int> layers;
+    std::vector<Eigen::MatrixXf> weights;
+    std::vector<Eigen::VectorXf> biases;
+
+    // methods
+    NeuralNetwork ();
+    NeuralNetwork (const std::vector<int>& layers);
+
+    void setLayers (const std::vector<int>& layers);
+    // new layer sizes, the weights of the units that remain are kept
+    void resize (const std::vector<int>& layers);
+    int inputCount ();
+    int outputCount ();
+
+    void forward (const Eigen::MatrixXf& inputs, Eigen::MatrixXf& outputs);
+
+    // flat parameter vector, used as genome by evolutionary runs
+    int genomeSize ();
+    std::vector<float> getGenome ();
+    void setGenome (const std::vector<float>& genome);
+    void randomize (float range);
+
+    bool load (const std::string& filename);
+    bool save (const std::string& filename);
+
+private :
+    std::vector<Eigen::MatrixXf> activations;
+};
+
+
+#endif
@@ -0,0 +1,68 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#include "ObstacleAvoidance.h"
+
+#include "aFish.h"
+
+
+// turn left if the right side is more obstructed, right otherwise
+static inline void kernel (float pl, float pr, float speed, float bias, float& ls, float& rs)
+{
+    float s = pr >= pl ? speed : -speed;
+    ls = bias - s;
+    rs = bias + s;
+}
+
+static inline float leftRays (aFish* fish)
+{
+    return (fish->rayFrontLU->getValue() + fish->rayFrontLD->getValue() + fish->rayLeft->getValue()) / 3.0;
+}
+
+static inline float rightRays (aFish* fish)
+{
+    return (fish->rayFrontRU->getValue() + fish->rayFrontRD->getValue() + fish->rayRight->getValue()) / 3.0;
+}
+
+static inline bool obstaclePerceived (aFish* fish)
+{
+    // don't take into account down obstacles, as it can be the ground...
+    return fish->rayFrontLU->hasHit()
+	|| fish->rayFrontRU->hasHit()
+	|| fish->rayLeft->hasHit()
+	|| fish->rayRight->hasHit();
+}
+
+
+bool ObstacleAvoidance::avoid (aFish* fish, float speed, float bias)
+{
+    // no obstacles to avoid, return immediately
+    if (!obstaclePerceived(fish))
+	return false;
+
+    float ls, rs;
+    kernel(leftRays(fish), rightRays(fish), speed, bias, ls, rs);
+
+    // change movement direction
+    fish->propellerLeft->setSpeed(ls);
+    fish->propellerRight->setSpeed(rs);
+
+    // advertise obstacle avoidance in progress
+    return true;
+}
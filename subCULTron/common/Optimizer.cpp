@@ -0,0 +1,370 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#include "Optimizer.h"
+#include "ProcessPool.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <gsl/gsl_randist.h>
+
+
+Optimizer::Optimizer (long int seed)
+{
+    random = gsl_rng_alloc(gsl_rng_mt19937);
+    gsl_rng_set(random, seed);
+    evaluated = 0;
+}
+
+Optimizer::~Optimizer ()
+{
+    gsl_rng_free(random);
+}
+
+void Optimizer::addParameter (const std::string& name, float min, float max)
+{
+    names.push_back(name);
+    this->min.push_back(min);
+    this->max.push_back(max);
+}
+
+bool Optimizer::load (const std::string& filename)
+{
+    std::ifstream file (filename.c_str());
+    if (!file.good())
+    {
+	std::cerr << "Optimizer : cannot read " << filename << std::endl;
+	return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+	std::istringstream in (line);
+	std::string key;
+	if (!(in >> key) || key[0] == '#')
+	    continue;
+
+	if (key == "parameter")
+	{
+	    std::string name;
+	    float a, b;
+	    in >> name >> a >> b;
+	    addParameter(name, a, b);
+	}
+	else if (key == "genome")
+	{
+	    // weights of a neural controller, bound as genome0, genome1, ...
+	    int count;
+	    float a, b;
+	    in >> count >> a >> b;
+	    for (int i = 0; i < count; i++)
+		addParameter("genome" + std::to_string(i), a, b);
+	}
+	else if (key == "measure") in >> measure;
+	else if (key == "population") in >> populationSize;
+	else if (key == "evaluations") in >> evaluations;
+	else if (key == "replicates") in >> replicates;
+	else if (key == "tournament") in >> tournamentSize;
+	else if (key == "crossover") in >> crossoverProba;
+	else if (key == "sigma") in >> mutationSigma;
+	else if (key == "checkpoint") in >> checkpointFilename;
+	else if (key == "checkpointPeriod") in >> checkpointPeriod;
+	else
+	{
+	    std::cerr << "Optimizer : unknown key " << key << " in " << filename << std::endl;
+	    return false;
+	}
+
+	if (in.fail())
+	{
+	    std::cerr << "Optimizer : malformed line '" << line << "' in " << filename << std::endl;
+	    return false;
+	}
+    }
+
+    return !names.empty();
+}
+
+void Optimizer::run (Evaluation evaluation, ProcessPool& pool)
+{
+    if (!checkpointFilename.empty() && loadCheckpoint())
+	std::cout << "Optimizer : resuming from " << checkpointFilename << " after " << evaluated << " evaluations" << std::endl;
+
+    std::map<int, std::vector<float> > pending;
+    int submitted = evaluated;
+
+    while (evaluated < evaluations)
+    {
+	// keep every worker busy
+	while (!pool.full() && submitted < evaluations)
+	{
+	    std::vector<float> genome;
+	    if (population.empty() || (int) (population.size() + pending.size()) < populationSize)
+		genome = randomGenome();
+	    else
+		genome = breed();
+
+	    submitted++;
+
+	    // identical candidate already evaluated, no simulation needed
+	    auto c = cache.find(genome);
+	    if (c != cache.end())
+	    {
+		insert(genome, c->second);
+		evaluated++;
+		continue;
+	    }
+
+	    // replicates use fixed seeds, so that cached fitnesses stay comparable
+	    int r = replicates;
+	    int id = pool.submit([evaluation, genome, r] () {
+		    float sum = 0;
+		    for (int i = 0; i < r; i++)
+			sum += evaluation(genome, i + 1);
+		    return std::vector<float> (1, sum / r);
+		});
+	    if (id < 0)
+	    {
+		std::cerr << "Optimizer : cannot start evaluation" << std::endl;
+		return;
+	    }
+	    pending[id] = genome;
+	}
+
+	if (pending.empty())
+	    continue;
+
+	// insert the first result available, whichever candidate it is
+	int id;
+	std::vector<float> result;
+	if (!pool.wait(id, result))
+	    return;
+
+	auto p = pending.find(id);
+	if (p == pending.end())
+	    continue;
+
+	float fitness = result.empty() ? -INFINITY : result[0];
+	cache[p->second] = fitness;
+	insert(p->second, fitness);
+	pending.erase(p);
+	evaluated++;
+
+	Individual b = best();
+	std::cout << "Optimizer : evaluation " << evaluated << " / " << evaluations << " fitness " << fitness << " best " << b.fitness << std::endl;
+
+	if (!checkpointFilename.empty() && evaluated % checkpointPeriod == 0)
+	    saveCheckpoint();
+    }
+
+    if (!checkpointFilename.empty())
+	saveCheckpoint();
+}
+
+Optimizer::Individual Optimizer::best ()
+{
+    Individual b;
+    b.fitness = -INFINITY;
+    for (auto& i : population)
+	if (b.genome.empty() || i.fitness > b.fitness)
+	    b = i;
+    return b;
+}
+
+std::vector<float> Optimizer::randomGenome ()
+{
+    std::vector<float> genome (names.size());
+    for (unsigned int i = 0; i < genome.size(); i++)
+	genome[i] = gsl_ran_flat(random, min[i], max[i]);
+    return genome;
+}
+
+const Optimizer::Individual& Optimizer::tournament ()
+{
+    int b = gsl_rng_uniform_int(random, population.size());
+    for (int i = 1; i < tournamentSize; i++)
+    {
+	int c = gsl_rng_uniform_int(random, population.size());
+	if (population[c].fitness > population[b].fitness)
+	    b = c;
+    }
+    return population[b];
+}
+
+std::vector<float> Optimizer::breed ()
+{
+    std::vector<float> genome = tournament().genome;
+
+    // uniform crossover
+    if (gsl_rng_uniform(random) < crossoverProba)
+    {
+	const std::vector<float>& other = tournament().genome;
+	for (unsigned int i = 0; i < genome.size(); i++)
+	    if (gsl_rng_uniform(random) < 0.5)
+		genome[i] = other[i];
+    }
+
+    // gaussian mutation, relative to the range of each parameter
+    for (unsigned int i = 0; i < genome.size(); i++)
+    {
+	genome[i] += gsl_ran_gaussian(random, mutationSigma * (max[i] - min[i]));
+	if (genome[i] < min[i]) genome[i] = min[i];
+	if (genome[i] > max[i]) genome[i] = max[i];
+    }
+
+    return genome;
+}
+
+void Optimizer::insert (const std::vector<float>& genome, float fitness)
+{
+    if (std::isnan(fitness))
+	fitness = -INFINITY;
+
+    Individual i;
+    i.genome = genome;
+    i.fitness = fitness;
+
+    if ((int) population.size() < populationSize)
+    {
+	population.push_back(i);
+	return;
+    }
+
+    // replace the worst individual if the newcomer is better
+    unsigned int w = 0;
+    for (unsigned int k = 1; k < population.size(); k++)
+	if (population[k].fitness < population[w].fitness)
+	    w = k;
+
+    if (fitness > population[w].fitness)
+	population[w] = i;
+}
+
+static void writeIndividual (std::ostream& out, const std::vector<float>& genome, float fitness)
+{
+    for (float g : genome)
+	out << g << " ";
+    out << fitness << std::endl;
+}
+
+static bool readIndividual (std::istream& in, int size, std::vector<float>& genome, float& fitness)
+{
+    genome.resize(size);
+    for (int k = 0; k < size; k++)
+	in >> genome[k];
+
+    // fitness may be -inf for failed evaluations
+    std::string f;
+    in >> f;
+    fitness = strtof(f.c_str(), NULL);
+
+    return !in.fail();
+}
+
+bool Optimizer::saveCheckpoint ()
+{
+    // write aside then rename, so that a crash never leaves a truncated file
+    std::string tmp = checkpointFilename + ".tmp";
+    std::ofstream file (tmp.c_str());
+    if (!file.good())
+	return false;
+
+    file.precision(9);
+    file << "evaluated " << evaluated << std::endl;
+
+    // random generator state, as hexadecimal bytes
+    const unsigned char* state = (const unsigned char*) gsl_rng_state(random);
+    size_t size = gsl_rng_size(random);
+    file << "rng " << size;
+    char hex[3];
+    for (size_t k = 0; k < size; k++)
+    {
+	snprintf(hex, sizeof(hex), "%02x", state[k]);
+	file << (k % 64 == 0 ? "\n" : "") << hex;
+    }
+    file << std::endl;
+
+    file << "population " << population.size() << std::endl;
+    for (auto& i : population)
+	writeIndividual(file, i.genome, i.fitness);
+
+    file << "cache " << cache.size() << std::endl;
+    for (auto& c : cache)
+	writeIndividual(file, c.first, c.second);
+
+    file.close();
+    if (file.fail())
+	return false;
+
+    return rename(tmp.c_str(), checkpointFilename.c_str()) == 0;
+}
+
+bool Optimizer::loadCheckpoint ()
+{
+    std::ifstream file (checkpointFilename.c_str());
+    if (!file.good())
+	return false;
+
+    std::string key;
+    int count;
+    size_t size;
+
+    file >> key >> evaluated;
+
+    // random generator state
+    file >> key >> size;
+    if (size != gsl_rng_size(random))
+    {
+	std::cerr << "Optimizer : incompatible random generator in " << checkpointFilename << std::endl;
+	return false;
+    }
+    unsigned char* state = (unsigned char*) gsl_rng_state(random);
+    for (size_t k = 0; k < size; k++)
+    {
+	char hex[3] = {0, 0, 0};
+	file >> hex[0] >> hex[1];
+	state[k] = strtol(hex, NULL, 16);
+    }
+
+    std::vector<float> genome;
+    float fitness;
+
+    population.clear();
+    file >> key >> count;
+    for (int i = 0; i < count && readIndividual(file, names.size(), genome, fitness); i++)
+    {
+	Individual ind;
+	ind.genome = genome;
+	ind.fitness = fitness;
+	population.push_back(ind);
+    }
+
+    cache.clear();
+    file >> key >> count;
+    for (int i = 0; i < count && readIndividual(file, names.size(), genome, fitness); i++)
+	cache[genome] = fitness;
+
+    return !file.fail();
+}
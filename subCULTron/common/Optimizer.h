@@ -0,0 +1,91 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <gsl/gsl_rng.h>
+
+class ProcessPool;
+
+// Steady state genetic algorithm maximising the fitness of real valued
+// parameters. Candidates are evaluated asynchronously in a ProcessPool :
+// as soon as one evaluation ends, its result is inserted in the population
+// and a new candidate is bred, so a slow replicate never stalls the others.
+class Optimizer
+{
+public :
+    struct Individual
+    {
+	std::vector<float> genome;
+	float fitness;
+    };
+
+    // evaluates a candidate for a given seed, runs in a worker process
+    typedef std::function<float(const std::vector<float>&, long int)> Evaluation;
+
+    // search space
+    std::vector<std::string> names;
+    std::vector<float> min;
+    std::vector<float> max;
+
+    // parameters
+    int populationSize = 20;
+    int evaluations = 500;
+    int replicates = 1;
+    int tournamentSize = 3;
+    float crossoverProba = 0.5;
+    float mutationSigma = 0.1;
+    std::string measure;
+    std::string checkpointFilename;
+    int checkpointPeriod = 10;
+
+    // state
+    std::vector<Individual> population;
+    std::map<std::vector<float>, float> cache;
+    int evaluated;
+    gsl_rng* random;
+
+    // methods
+    Optimizer (long int seed = 0);
+    ~Optimizer ();
+
+    void addParameter (const std::string& name, float min, float max);
+    bool load (const std::string& filename);
+
+    void run (Evaluation evaluation, ProcessPool& pool);
+    Individual best ();
+
+    bool saveCheckpoint ();
+    bool loadCheckpoint ();
+
+private :
+    std::vector<float> randomGenome ();
+    std::vector<float> breed ();
+    const Individual& tournament ();
+    void insert (const std::vector<float>& genome, float fitness);
+};
+
+
+#endif
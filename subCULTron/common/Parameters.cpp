@@ -0,0 +1,200 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#include "Parameters.h"
+
+#include <cmath>
+#include <cstdlib>
+
+std::map<std::string, std::vector<float*> > Parameters::floats;
+std::map<std::string, std::vector<int*> > Parameters::ints;
+std::map<std::string, std::vector<std::string*> > Parameters::strings;
+std::map<std::string, std::function<float()> > Parameters::measures;
+std::map<std::string, float> Parameters::values;
+std::map<std::string, std::string> Parameters::texts;
+std::map<std::string, float> Parameters::scales;
+
+
+void Parameters::bind (const std::string& name, float& field)
+{
+    auto it = values.find(name);
+    if (it != values.end())
+	field = it->second;
+    else if (scales.count(name))
+	field *= scales[name];
+
+    floats[name].push_back(&field);
+}
+
+void Parameters::bind (const std::string& name, int& field)
+{
+    auto it = values.find(name);
+    if (it != values.end())
+	field = lround(it->second);
+    else if (scales.count(name))
+	field = lround(field * scales[name]);
+
+    ints[name].push_back(&field);
+}
+
+void Parameters::bind (const std::string& name, std::string& field)
+{
+    auto it = texts.find(name);
+    if (it != texts.end())
+	field = it->second;
+
+    strings[name].push_back(&field);
+}
+
+void Parameters::measure (const std::string& name, std::function<float()> function)
+{
+    measures[name] = function;
+}
+
+void Parameters::clear ()
+{
+    floats.clear();
+    ints.clear();
+    strings.clear();
+    measures.clear();
+}
+
+void Parameters::set (const std::string& name, float value)
+{
+    values[name] = value;
+
+    // also update fields that are already bound
+    auto f = floats.find(name);
+    if (f != floats.end())
+	for (float* p : f->second)
+	    *p = value;
+
+    auto i = ints.find(name);
+    if (i != ints.end())
+	for (int* p : i->second)
+	    *p = lround(value);
+}
+
+void Parameters::set (const std::string& name, const std::string& text)
+{
+    texts[name] = text;
+
+    auto s = strings.find(name);
+    if (s != strings.end())
+	for (std::string* p : s->second)
+	    *p = text;
+}
+
+bool Parameters::set (const std::string& assignment)
+{
+    // name=value
+    size_t pos = assignment.find('=');
+    if (pos == std::string::npos || pos == 0)
+	return false;
+
+    const char* start = assignment.c_str() + pos + 1;
+    char* end;
+    float value = strtof(start, &end);
+    if (end == start || *end != '\0')
+	set(assignment.substr(0, pos), std::string (start));
+    else
+	set(assignment.substr(0, pos), value);
+    return true;
+}
+
+void Parameters::unset ()
+{
+    values.clear();
+    texts.clear();
+    scales.clear();
+}
+
+void Parameters::scale (const std::string& name, float factor)
+{
+    scales[name] = factor;
+}
+
+bool Parameters::has (const std::string& name)
+{
+    return floats.count(name) || ints.count(name) || strings.count(name);
+}
+
+bool Parameters::given (const std::string& name)
+{
+    return values.count(name) || texts.count(name);
+}
+
+float Parameters::get (const std::string& name)
+{
+    auto f = floats.find(name);
+    if (f != floats.end() && !f->second.empty())
+	return *f->second.front();
+
+    auto i = ints.find(name);
+    if (i != ints.end() && !i->second.empty())
+	return *i->second.front();
+
+    return NAN;
+}
+
+std::vector<std::string> Parameters::names ()
+{
+    std::vector<std::string> n;
+    for (auto& f : floats)
+	n.push_back(f.first);
+    for (auto& i : ints)
+	n.push_back(i.first);
+    for (auto& s : strings)
+	n.push_back(s.first);
+    return n;
+}
+
+std::vector<std::string> Parameters::unbound ()
+{
+    std::vector<std::string> n;
+    for (auto& v : values)
+	if (!has(v.first))
+	    n.push_back(v.first);
+    for (auto& t : texts)
+	if (!has(t.first))
+	    n.push_back(t.first);
+    return n;
+}
+
+bool Parameters::hasMeasure (const std::string& name)
+{
+    return measures.count(name);
+}
+
+float Parameters::getMeasure (const std::string& name)
+{
+    auto m = measures.find(name);
+    if (m == measures.end())
+	return NAN;
+
+    return m->second();
+}
+
+std::vector<std::string> Parameters::measureNames ()
+{
+    std::vector<std::string> n;
+    for (auto& m : measures)
+	n.push_back(m.first);
+    return n;
+}
@@ -0,0 +1,80 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#ifndef PARAMETERS_H
+#define PARAMETERS_H
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+// Registers a member field under its own name. Call it in the constructor,
+// before the field is used : a value set from the command line, a sweep or
+// an optimiser is copied into the field at that point.
+#define PARAMETER(field) Parameters::bind (#field, field)
+
+// Registry of the named parameters and measures of an experiment. Several
+// instances may bind the same name (e.g. one per controller), they all
+// receive the same value.
+class Parameters
+{
+public :
+    // bindings, done by experiments and controllers
+    static void bind (const std::string& name, float& field);
+    static void bind (const std::string& name, int& field);
+    static void bind (const std::string& name, std::string& field);
+    static void measure (const std::string& name, std::function<float()> function);
+    static void clear ();
+
+    // values given before the experiment is built
+    static void set (const std::string& name, float value);
+    static void set (const std::string& name, const std::string& text);
+    // name=value, a value that is not a number is given as text
+    static bool set (const std::string& assignment);
+    static void unset ();
+
+    // factor applied to the default of a parameter when it is bound,
+    // values given explicitly are kept as they are
+    static void scale (const std::string& name, float factor);
+
+    // queries
+    static bool has (const std::string& name);
+    // a value was given for the name, bound or not
+    static bool given (const std::string& name);
+    static float get (const std::string& name);
+    static std::vector<std::string> names ();
+    // values given that no field is bound to
+    static std::vector<std::string> unbound ();
+    static bool hasMeasure (const std::string& name);
+    static float getMeasure (const std::string& name);
+    static std::vector<std::string> measureNames ();
+
+private :
+    static std::map<std::string, std::vector<float*> > floats;
+    static std::map<std::string, std::vector<int*> > ints;
+    static std::map<std::string, std::vector<std::string*> > strings;
+    static std::map<std::string, std::function<float()> > measures;
+    static std::map<std::string, float> values;
+    static std::map<std::string, std::string> texts;
+    static std::map<std::string, float> scales;
+};
+
+
+#endif
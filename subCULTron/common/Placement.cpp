@@ -0,0 +1,104 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#include "Placement.h"
+#include "Log.h"
+
+#include <cmath>
+
+#include <gsl/gsl_rng.h>
+extern gsl_rng* rng;
+
+
+Placement::Placement ()
+{
+    overlaps = 0;
+    maxRadius = 0.0;
+    cell = 0.0;
+}
+
+Placement::~Placement ()
+{
+    if (overlaps > 0)
+	LOG(LOG_WARNING) << "Placement : " << overlaps << " of " << points.size()
+			 << " agents overlap, the arena is too crowded";
+}
+
+int64_t Placement::key (int i, int j)
+{
+    return (int64_t(i) << 32) ^ uint32_t(j);
+}
+
+// distance left between the footprint at p and the closest one placed,
+// negative when they overlap
+float Placement::clearance (const btVector3& p, float radius)
+{
+    float best = INFINITY;
+    int range = ceil((radius + maxRadius) / cell);
+    int ci = floor(p.x() / cell);
+    int cj = floor(p.y() / cell);
+
+    for (int i = ci - range; i <= ci + range; i++)
+	for (int j = cj - range; j <= cj + range; j++)
+	{
+	    auto it = grid.find(key(i, j));
+	    if (it == grid.end())
+		continue;
+	    for (int k : it->second)
+		best = std::min(best, (points[k] - p).length() - radii[k] - radius);
+	}
+
+    return best;
+}
+
+btVector3 Placement::disc (float radius, const btVector3& dimensions)
+{
+    // footprint of any heading
+    float r = 0.5 * sqrt(dimensions.x() * dimensions.x() + dimensions.y() * dimensions.y());
+    if (cell == 0.0)
+	cell = std::max(2.0f * r, 1e-3f);
+
+    btVector3 best;
+    float bestClearance = -INFINITY;
+    for (int a = 0; a < attempts; a++)
+    {
+	// uniform over the area of the disc
+	float distance = sqrt(gsl_rng_uniform(rng)) * radius;
+	float angle = gsl_rng_uniform(rng) * 2.0 * M_PI - M_PI;
+	btVector3 p (cos(angle) * distance, sin(angle) * distance, 0.0);
+
+	float c = clearance(p, r);
+	if (c > bestClearance)
+	{
+	    best = p;
+	    bestClearance = c;
+	}
+	if (c >= 0.0)
+	    break;
+    }
+    if (bestClearance < 0.0)
+	overlaps++;
+
+    points.push_back(best);
+    radii.push_back(r);
+    maxRadius = std::max(maxRadius, r);
+    grid[key(floor(best.x() / cell), floor(best.y() / cell))].push_back(points.size() - 1);
+
+    return best;
+}
@@ -0,0 +1,63 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#ifndef PLACEMENT_H
+#define PLACEMENT_H
+
+#include <LinearMath/btVector3.h>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Initial positions of the agents, drawn uniformly in a disc of the
+// horizontal plane without overlapping the positions already given (dart
+// throwing over a grid, so the cost stays linear in the number of agents).
+// One placement is shared by all the agents of a reset. When no free spot
+// is found after a number of draws, the candidate with the most room is
+// taken and counted as an overlap.
+class Placement
+{
+public :
+    // parameters
+    int attempts = 100;
+
+    // methods
+    Placement ();
+    ~Placement ();
+
+    // z is left to 0, dimensions give the footprint of the agent
+    btVector3 disc (float radius, const btVector3& dimensions);
+
+    int overlaps;
+
+private :
+    std::vector<btVector3> points;
+    std::vector<float> radii;
+    float maxRadius;
+
+    float cell;
+    std::unordered_map<int64_t, std::vector<int> > grid;
+
+    int64_t key (int i, int j);
+    float clearance (const btVector3& p, float radius);
+};
+
+
+#endif
@@ -0,0 +1,190 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#include "ProcessPool.h"
+#include "Log.h"
+
+#include <cerrno>
+#include <iostream>
+
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+
+static bool writeAll (int fd, const void* data, size_t size)
+{
+    const char* p = (const char*) data;
+    while (size > 0)
+    {
+	ssize_t n = write(fd, p, size);
+	if (n < 0 && errno == EINTR) continue;
+	if (n <= 0) return false;
+	p += n;
+	size -= n;
+    }
+    return true;
+}
+
+static bool readAll (int fd, void* data, size_t size)
+{
+    char* p = (char*) data;
+    while (size > 0)
+    {
+	ssize_t n = read(fd, p, size);
+	if (n < 0 && errno == EINTR) continue;
+	if (n <= 0) return false;
+	p += n;
+	size -= n;
+    }
+    return true;
+}
+
+
+ProcessPool::ProcessPool (int workers)
+{
+    if (workers <= 0)
+	workers = sysconf(_SC_NPROCESSORS_ONLN);
+    if (workers <= 0)
+	workers = 1;
+
+    this->workers = workers;
+    nextId = 0;
+}
+
+ProcessPool::~ProcessPool ()
+{
+    // collect remaining workers
+    int id;
+    std::vector<float> result;
+    while (running() > 0)
+	wait(id, result);
+}
+
+bool ProcessPool::full ()
+{
+    return running() >= workers;
+}
+
+int ProcessPool::running ()
+{
+    return processes.size();
+}
+
+int ProcessPool::submit (Job job)
+{
+    // make room if needed : caller should check full() first
+    if (full())
+    {
+	std::cerr << "ProcessPool : no free worker, submit called on a full pool" << std::endl;
+	return -1;
+    }
+
+    int fds[2];
+    if (pipe(fds) != 0)
+	return -1;
+
+    // flush streams so that buffered output is not duplicated in the child
+    Log::flush();
+    std::cerr.flush();
+
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+	close(fds[0]);
+	close(fds[1]);
+	return -1;
+    }
+
+    // child : run the job, send results back and leave without cleanup
+    if (pid == 0)
+    {
+	close(fds[0]);
+	std::vector<float> result = job();
+	unsigned int size = result.size();
+	bool ok = writeAll(fds[1], &size, sizeof(size))
+	    && writeAll(fds[1], result.data(), size * sizeof(float));
+	close(fds[1]);
+	Log::flush();
+	_exit(ok ? 0 : 1);
+    }
+
+    // parent
+    close(fds[1]);
+    Worker w;
+    w.id = nextId++;
+    w.fd = fds[0];
+    processes[pid] = w;
+
+    return w.id;
+}
+
+bool ProcessPool::wait (int& id, std::vector<float>& result)
+{
+    result.clear();
+    if (processes.empty())
+	return false;
+
+    // pick up the first worker to send its result, whichever it is
+    std::vector<pollfd> fds;
+    std::vector<pid_t> pids;
+    for (auto& p : processes)
+    {
+	pollfd pfd;
+	pfd.fd = p.second.fd;
+	pfd.events = POLLIN;
+	pfd.revents = 0;
+	fds.push_back(pfd);
+	pids.push_back(p.first);
+    }
+
+    int n;
+    do
+    {
+	n = poll(fds.data(), fds.size(), -1);
+    }
+    while (n < 0 && errno == EINTR);
+
+    unsigned int k = 0;
+    while (k < fds.size() && fds[k].revents == 0)
+	k++;
+    if (n <= 0 || k == fds.size())
+	return false;
+
+    pid_t pid = pids[k];
+    Worker w = processes[pid];
+    processes.erase(pid);
+    id = w.id;
+
+    // read before reaping so that large results never block the child,
+    // a crashed worker reports an empty result
+    unsigned int size = 0;
+    if (readAll(w.fd, &size, sizeof(size)))
+    {
+	result.resize(size);
+	if (!readAll(w.fd, result.data(), size * sizeof(float)))
+	    result.clear();
+    }
+    close(w.fd);
+
+    int status;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR);
+
+    return true;
+}
@@ -0,0 +1,62 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#ifndef PROCESS_POOL_H
+#define PROCESS_POOL_H
+
+#include <functional>
+#include <map>
+#include <vector>
+
+#include <sys/types.h>
+
+// Runs headless simulations in forked worker processes. The simulator keeps
+// global state (random number generator, physics world), so processes are
+// used rather than threads. Jobs complete asynchronously : the caller
+// submits while slots are free and collects whichever job ends first.
+class ProcessPool
+{
+public :
+    typedef std::function<std::vector<float>()> Job;
+
+    int workers;
+
+    // methods
+    ProcessPool (int workers = 0);
+    ~ProcessPool ();
+
+    bool full ();
+    int running ();
+
+    int submit (Job job);
+    bool wait (int& id, std::vector<float>& result);
+
+private :
+    struct Worker
+    {
+	int id;
+	int fd;
+    };
+
+    int nextId;
+    std::map<pid_t, Worker> processes;
+};
+
+
+#endif
@@ -0,0 +1,258 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#include "Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+
+#include <cxxabi.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PROFILER_TSC
+#endif
+
+bool Profiler::enabled = false;
+std::string Profiler::traceFilename;
+
+
+namespace
+{
+    // durations are binned by power of two, with 8 linear steps in each,
+    // percentiles are read back within 12.5%
+    const int subBins = 8;
+    const int bins = 64 * subBins;
+
+    int bin (uint64_t ticks)
+    {
+	if (ticks < (uint64_t) subBins)
+	    return ticks;
+	int e = 63 - __builtin_clzll(ticks);
+	return (e - 2) * subBins + ((ticks >> (e - 3)) & (subBins - 1));
+    }
+
+    uint64_t binStart (int b)
+    {
+	if (b < subBins)
+	    return b;
+	int e = b / subBins + 2;
+	return (uint64_t(subBins) + b % subBins) << (e - 3);
+    }
+
+    struct Section
+    {
+	std::string name;
+	uint64_t calls = 0;
+	uint64_t total = 0;
+	uint64_t max = 0;
+	std::vector<uint64_t> histogram = std::vector<uint64_t> (bins, 0);
+
+	uint64_t percentile (float p) const
+	{
+	    uint64_t rank = p * calls;
+	    uint64_t n = 0;
+	    for (int b = 0; b < bins; b++)
+	    {
+		n += histogram[b];
+		if (n > rank)
+		    return std::min(binStart(b), max);
+	    }
+	    return max;
+	}
+    };
+
+    struct Event
+    {
+	int section;
+	uint64_t start;
+	uint64_t duration;
+    };
+
+    std::vector<Section> sections;
+
+    // the timeline is bounded, later calls are only counted in the summary
+    const size_t traceLimit = 1 << 22;
+    std::vector<Event> events;
+
+    // clock of reference for the time stamp counter
+    uint64_t startTicks = 0;
+    std::chrono::steady_clock::time_point startTime;
+
+    double ticksPerSecond ()
+    {
+#ifdef PROFILER_TSC
+	double seconds = std::chrono::duration<double> (std::chrono::steady_clock::now() - startTime).count();
+	if (seconds <= 0.0)
+	    return 1e9;
+	return (Profiler::now() - startTicks) / seconds;
+#else
+	return 1e9;
+#endif
+    }
+}
+
+int Profiler::section (const std::string& name)
+{
+    for (unsigned int i = 0; i < sections.size(); i++)
+	if (sections[i].name == name)
+	    return i;
+
+    sections.push_back(Section ());
+    sections.back().name = name;
+
+    return sections.size() - 1;
+}
+
+std::string Profiler::name (const std::type_info& type)
+{
+    int status;
+    char* demangled = abi::__cxa_demangle(type.name(), NULL, NULL, &status);
+    std::string result = status == 0 ? demangled : type.name();
+    free(demangled);
+
+    return result;
+}
+
+uint64_t Profiler::now ()
+{
+#ifdef PROFILER_TSC
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds> (std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+void Profiler::record (int section, uint64_t start, uint64_t end)
+{
+    Section& s = sections[section];
+    uint64_t ticks = end - start;
+    s.calls++;
+    s.total += ticks;
+    s.max = std::max(s.max, ticks);
+    s.histogram[bin(ticks)]++;
+
+    if (!traceFilename.empty() && events.size() < traceLimit)
+	events.push_back(Event {section, start, ticks});
+}
+
+void Profiler::start ()
+{
+    for (Section& s : sections)
+    {
+	s.calls = s.total = s.max = 0;
+	std::fill(s.histogram.begin(), s.histogram.end(), 0);
+    }
+    events.clear();
+
+    startTime = std::chrono::steady_clock::now();
+    startTicks = now();
+}
+
+void Profiler::report (std::ostream& out)
+{
+    double tps = ticksPerSecond();
+    double wall = (now() - startTicks) / tps;
+
+    std::vector<const Section*> sorted;
+    for (const Section& s : sections)
+	if (s.calls > 0)
+	    sorted.push_back(&s);
+    std::sort(sorted.begin(), sorted.end(), [] (const Section* a, const Section* b) { return a->total > b->total; });
+
+    double us = 1e6 / tps;
+    out << "Profile over " << wall << " s of wall time" << std::endl;
+    out << std::left << std::setw(28) << "section" << std::right
+	<< std::setw(10) << "calls" << std::setw(10) << "total s" << std::setw(8) << "share"
+	<< std::setw(10) << "mean us" << std::setw(10) << "p50 us" << std::setw(10) << "p90 us"
+	<< std::setw(10) << "p99 us" << std::setw(10) << "max us" << std::endl;
+
+    out << std::fixed;
+    for (const Section* s : sorted)
+	out << std::left << std::setw(28) << s->name << std::right
+	    << std::setw(10) << s->calls
+	    << std::setw(10) << std::setprecision(3) << s->total / tps
+	    << std::setw(7) << std::setprecision(1) << 100.0 * s->total / tps / wall << "%"
+	    << std::setw(10) << std::setprecision(2) << s->total * us / s->calls
+	    << std::setw(10) << s->percentile(0.5) * us
+	    << std::setw(10) << s->percentile(0.9) * us
+	    << std::setw(10) << s->percentile(0.99) * us
+	    << std::setw(10) << s->max * us << std::endl;
+    out << std::defaultfloat;
+
+    if (events.size() == traceLimit)
+	out << "Trace truncated to the first " << traceLimit << " calls" << std::endl;
+}
+
+std::vector<std::string> Profiler::names ()
+{
+    std::vector<std::string> result;
+    for (const Section& s : sections)
+	result.push_back(s.name);
+
+    return result;
+}
+
+uint64_t Profiler::calls (const std::string& name)
+{
+    for (const Section& s : sections)
+	if (s.name == name)
+	    return s.calls;
+
+    return 0;
+}
+
+double Profiler::seconds (const std::string& name)
+{
+    for (const Section& s : sections)
+	if (s.name == name)
+	    return s.total / ticksPerSecond();
+
+    return 0.0;
+}
+
+bool Profiler::writeTrace (const std::string& filename)
+{
+    FILE* file = fopen(filename.c_str(), "w");
+    if (!file)
+    {
+	std::cerr << "Profiler : cannot write " << filename << std::endl;
+	return false;
+    }
+
+    // complete events, time in microseconds since the start of the run
+    double us = 1e6 / ticksPerSecond();
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    for (size_t i = 0; i < events.size(); i++)
+	fprintf(file, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":%.3f,\"dur\":%.3f}%s\n",
+		sections[events[i].section].name.c_str(), (events[i].start - startTicks) * us,
+		events[i].duration * us, i + 1 < events.size() ? "," : "");
+    fprintf(file, "]}\n");
+
+    if (fclose(file) != 0)
+    {
+	std::cerr << "Profiler : error while writing " << filename << std::endl;
+	return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,94 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+// Time spent per section of the simulation step, measured with the time
+// stamp counter. Sections are the services and controller classes wrapped
+// in Profiled, or any block holding a Profiler::Scope. A summary with
+// percentiles per call is printed at the end of the run and every call can
+// be written to a Chrome trace / Perfetto timeline. Measures are taken on
+// the simulation thread only.
+class Profiler
+{
+public :
+    // set from the command line, nothing is measured otherwise
+    static bool enabled;
+    static std::string traceFilename;
+
+    // section registered once, by name
+    static int section (const std::string& name);
+    static std::string name (const std::type_info& type);
+
+    static uint64_t now ();
+    static void record (int section, uint64_t start, uint64_t end);
+
+    static void start ();
+    static void report (std::ostream& out);
+
+    // measures since start, per section
+    static std::vector<std::string> names ();
+    static uint64_t calls (const std::string& name);
+    static double seconds (const std::string& name);
+    static bool writeTrace (const std::string& filename);
+
+    class Scope
+    {
+    public :
+	Scope (int section) : section (section), begin (enabled ? now() : 0) {}
+	~Scope () { if (enabled) record(section, begin, now()); }
+
+    private :
+	int section;
+	uint64_t begin;
+    };
+};
+
+// Service or controller whose step is measured under its class name,
+// e.g. new Profiled<PhysicsBullet> () or new Profiled<ControllerAFish> (r)
+template <class T>
+class Profiled : public T
+{
+public :
+    template <class... Args> Profiled (Args&&... args) :
+	T (std::forward<Args>(args)...),
+	section (Profiler::section(Profiler::name(typeid(T))))
+    {
+    }
+
+    void step ()
+    {
+	Profiler::Scope scope (section);
+	T::step();
+    }
+
+private :
+    int section;
+};
+
+
+#endif
@@ -0,0 +1,158 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#include "Snapshot.h"
+#include "Object.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+extern gsl_rng* rng;
+
+// file layout : magic, version, payload size, payload
+static const char magic[4] = {'F', 'S', 'N', 'P'};
+static const unsigned int version = 1;
+
+std::vector<Snapshot::Section> Snapshot::sections;
+
+
+Snapshot::Snapshot ()
+{
+}
+
+void Snapshot::bytes (void* p, size_t size)
+{
+    const char* c = (const char*) p;
+    data.insert(data.end(), c, c + size);
+}
+
+void Snapshot::io (std::string& s)
+{
+    unsigned int n = s.size();
+    io(n);
+    if (n > 0)
+	bytes(&s[0], n);
+}
+
+void Snapshot::io (btVector3& v)
+{
+    btScalar x = v.x();
+    btScalar y = v.y();
+    btScalar z = v.z();
+    io(x);
+    io(y);
+    io(z);
+}
+
+void Snapshot::io (btTransform& t)
+{
+    // the opengl matrix is a plain copy of basis and origin, no rounding
+    btScalar m[16];
+    t.getOpenGLMatrix(m);
+    for (int i = 0; i < 16; i++)
+	io(m[i]);
+}
+
+void Snapshot::random (gsl_rng* r)
+{
+    // the state is copied as is, after the name of the generator
+    std::string name = gsl_rng_name(r);
+    unsigned int size = gsl_rng_size(r);
+    io(name);
+    io(size);
+    bytes(gsl_rng_state(r), size);
+}
+
+void Snapshot::body (btRigidBody* body)
+{
+    btTransform world = body->getWorldTransform();
+    btTransform interpolation = body->getInterpolationWorldTransform();
+    btVector3 linear = body->getLinearVelocity();
+    btVector3 angular = body->getAngularVelocity();
+    btVector3 interpolationLinear = body->getInterpolationLinearVelocity();
+    btVector3 interpolationAngular = body->getInterpolationAngularVelocity();
+    btVector3 force = body->getTotalForce();
+    btVector3 torque = body->getTotalTorque();
+    int activation = body->getActivationState();
+    btScalar deactivation = body->getDeactivationTime();
+
+    io(world);
+    io(interpolation);
+    io(linear);
+    io(angular);
+    io(interpolationLinear);
+    io(interpolationAngular);
+    io(force);
+    io(torque);
+    io(activation);
+    io(deactivation);
+}
+
+bool Snapshot::write (const std::string& filename)
+{
+    // write aside then rename, an interrupted save keeps the previous file
+    std::string tmp = filename + ".tmp";
+    std::ofstream file (tmp.c_str(), std::ios::binary);
+    if (!file.good())
+    {
+	std::cerr << "Snapshot : cannot write " << filename << std::endl;
+	return false;
+    }
+
+    unsigned long long size = data.size();
+    file.write(magic, sizeof(magic));
+    file.write((const char*) &version, sizeof(version));
+    file.write((const char*) &size, sizeof(size));
+    file.write(data.data(), data.size());
+    file.close();
+
+    if (file.fail() || rename(tmp.c_str(), filename.c_str()) != 0)
+    {
+	std::cerr << "Snapshot : cannot write " << filename << std::endl;
+	return false;
+    }
+
+    return true;
+}
+
+void Snapshot::provide (Section section)
+{
+    sections.push_back(section);
+}
+
+void Snapshot::clear ()
+{
+    sections.clear();
+}
+
+bool Snapshot::available ()
+{
+    return !sections.empty();
+}
+
+bool Snapshot::save (const std::string& filename)
+{
+    Snapshot s;
+    s.random(rng);
+    for (Section& section : sections)
+	section(s);
+
+    return s.write(filename);
+}
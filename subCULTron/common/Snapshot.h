@@ -0,0 +1,87 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstring>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <gsl/gsl_rng.h>
+
+class btRigidBody;
+class btTransform;
+class btVector3;
+
+// Binary image of the dynamic state of a running experiment, saved for
+// inspection : every io() call appends a field to the buffer. Experiments
+// list their state once in a section, registered at construction like
+// measures.
+//
+// Snapshots cannot be resumed : propeller set points, optical messages in
+// flight, the water clock and the Bullet contact cache (manifolds and their
+// warm-start impulses) are not captured.
+class Snapshot
+{
+public :
+    typedef std::function<void(Snapshot&)> Section;
+
+    // methods
+    Snapshot ();
+
+    template <class T> void io (T& value)
+    {
+	static_assert(std::is_trivially_copyable<T>::value, "Snapshot : field must be plain data");
+	bytes(&value, sizeof(T));
+    }
+    template <class T> void io (std::vector<T>& values)
+    {
+	unsigned int n = values.size();
+	io(n);
+	for (T& v : values)
+	    io(v);
+    }
+    void io (std::string& s);
+    void io (btVector3& v);
+    void io (btTransform& t);
+
+    void random (gsl_rng* r);
+    void body (btRigidBody* body);
+
+    bool write (const std::string& filename);
+
+    // state of the experiment being run, captured with the global rng
+    static void provide (Section section);
+    static void clear ();
+    static bool available ();
+    static bool save (const std::string& filename);
+
+private :
+    std::vector<char> data;
+
+    void bytes (void* p, size_t size);
+
+    static std::vector<Section> sections;
+};
+
+
+#endif
@@ -0,0 +1,200 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#include "StopCriterion.h"
+#include "Snapshot.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+StopCriterion::StopCriterion (const std::string& name, std::function<float()> measure, float duration)
+{
+    this->name = name;
+    this->measure = measure;
+    this->duration = duration;
+
+    reset();
+}
+
+StopCriterion::~StopCriterion ()
+{
+}
+
+void StopCriterion::reset ()
+{
+    value = NAN;
+    holdStartTime = 0.0;
+    holding = false;
+}
+
+void StopCriterion::snapshot (Snapshot& s)
+{
+    s.io(value);
+    s.io(holdStartTime);
+    s.io(holding);
+}
+
+bool StopCriterion::update (float time)
+{
+    value = measure();
+
+    if (!holds(value))
+    {
+	holding = false;
+	return false;
+    }
+
+    // condition just started to hold
+    if (!holding)
+    {
+	holding = true;
+	holdStartTime = time;
+    }
+
+    return time - holdStartTime >= duration;
+}
+
+
+ThresholdCriterion::ThresholdCriterion (const std::string& name, std::function<float()> measure, float threshold, bool below, float duration) :
+    StopCriterion (name, measure, duration)
+{
+    this->threshold = threshold;
+    this->below = below;
+}
+
+bool ThresholdCriterion::holds (float value)
+{
+    if (below)
+	return value < threshold;
+    else
+	return value > threshold;
+}
+
+
+StableCriterion::StableCriterion (const std::string& name, std::function<float()> measure, float duration, float tolerance) :
+    StopCriterion (name, measure, duration)
+{
+    this->tolerance = tolerance;
+    reference = 0.0;
+    hasReference = false;
+}
+
+void StableCriterion::reset ()
+{
+    StopCriterion::reset();
+    reference = 0.0;
+    hasReference = false;
+}
+
+void StableCriterion::snapshot (Snapshot& s)
+{
+    StopCriterion::snapshot(s);
+    s.io(reference);
+    s.io(hasReference);
+}
+
+bool StableCriterion::holds (float value)
+{
+    // any change restarts the clock from the new value
+    if (!hasReference || fabs(value - reference) > tolerance)
+    {
+	reference = value;
+	hasReference = true;
+	holding = false;
+    }
+
+    return true;
+}
+
+
+std::vector<StopCriteria*> StopCriteria::instances;
+
+StopCriteria::StopCriteria ()
+{
+    reset();
+    instances.push_back(this);
+}
+
+StopCriteria::~StopCriteria ()
+{
+    for (StopCriterion* c : criteria)
+	delete c;
+
+    instances.erase(std::remove(instances.begin(), instances.end(), this), instances.end());
+}
+
+void StopCriteria::add (StopCriterion* criterion)
+{
+    criteria.push_back(criterion);
+}
+
+void StopCriteria::reset ()
+{
+    stopTime = NAN;
+    stoppedBy.clear();
+    lastCheckTime = -INFINITY;
+
+    for (StopCriterion* c : criteria)
+	c->reset();
+}
+
+void StopCriteria::snapshot (Snapshot& s)
+{
+    s.io(stopTime);
+    s.io(stoppedBy);
+    s.io(lastCheckTime);
+
+    for (StopCriterion* c : criteria)
+	c->snapshot(s);
+}
+
+bool StopCriteria::check (float time)
+{
+    if (stopped())
+	return true;
+
+    // measures are evaluated once per period only
+    if (time - lastCheckTime < period)
+	return false;
+    lastCheckTime = time;
+
+    for (StopCriterion* c : criteria)
+    {
+	if (c->update(time))
+	{
+	    stopTime = time;
+	    stoppedBy = c->name;
+	    return true;
+	}
+    }
+
+    return false;
+}
+
+bool StopCriteria::stopped ()
+{
+    return !stoppedBy.empty();
+}
+
+void StopCriteria::resetAll ()
+{
+    for (StopCriteria* s : instances)
+	s->reset();
+}
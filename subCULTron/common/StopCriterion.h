@@ -0,0 +1,119 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#ifndef STOP_CRITERION_H
+#define STOP_CRITERION_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+class Snapshot;
+
+// Condition ending a headless run once its outcome is settled. Criteria are
+// updated periodically during the run and keep their own state, so holding
+// a condition for some duration costs nothing more than one evaluation.
+class StopCriterion
+{
+public :
+    std::string name;
+    std::function<float()> measure;
+    float duration;
+
+    // working variables
+    float value;
+    float holdStartTime;
+    bool holding;
+
+    // methods
+    StopCriterion (const std::string& name, std::function<float()> measure, float duration);
+    virtual ~StopCriterion ();
+
+    virtual void reset ();
+    virtual void snapshot (Snapshot& s);
+    bool update (float time);
+
+protected :
+    // whether the condition holds for the value just measured
+    virtual bool holds (float value) = 0;
+};
+
+// measure below (or above) a threshold for a given duration
+class ThresholdCriterion : public StopCriterion
+{
+public :
+    float threshold;
+    bool below;
+
+    ThresholdCriterion (const std::string& name, std::function<float()> measure, float threshold, bool below, float duration = 0.0);
+
+protected :
+    bool holds (float value);
+};
+
+// measure unchanged for a given duration
+class StableCriterion : public StopCriterion
+{
+public :
+    float tolerance;
+
+    StableCriterion (const std::string& name, std::function<float()> measure, float duration, float tolerance = 0.0);
+
+    void reset ();
+    void snapshot (Snapshot& s);
+
+protected :
+    float reference;
+    bool hasReference;
+
+    bool holds (float value);
+};
+
+// set of criteria, the first satisfied one stops the run
+class StopCriteria
+{
+public :
+    std::vector<StopCriterion*> criteria;
+    float period = 1.0;
+
+    // outcome
+    float stopTime;
+    std::string stoppedBy;
+
+    // methods
+    StopCriteria ();
+    ~StopCriteria ();
+
+    void add (StopCriterion* criterion);
+    void reset ();
+    void snapshot (Snapshot& s);
+    bool check (float time);
+    bool stopped ();
+
+    // every set alive in the process, e.g. before a sweep branch runs on
+    static void resetAll ();
+
+private :
+    float lastCheckTime;
+
+    static std::vector<StopCriteria*> instances;
+};
+
+
+#endif
@@ -0,0 +1,248 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#include "Sweep.h"
+#include "ProcessPool.h"
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+#include <sys/time.h>
+
+#include <gsl/gsl_rng.h>
+#include <gsl/gsl_randist.h>
+
+
+bool Sweep::load (const std::string& filename)
+{
+    std::ifstream file (filename.c_str());
+    if (!file.good())
+    {
+	std::cerr << "Sweep : cannot read " << filename << std::endl;
+	return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+	std::istringstream in (line);
+	std::string key;
+	if (!(in >> key) || key[0] == '#')
+	    continue;
+
+	if (key == "grid")
+	{
+	    // grid name v1 v2 v3 ...
+	    std::string name;
+	    in >> name;
+	    std::vector<float> values;
+	    float v;
+	    while (in >> v)
+		values.push_back(v);
+	    in.clear();
+	    if (values.empty())
+		in.setstate(std::ios::failbit);
+	    gridNames.push_back(name);
+	    gridValues.push_back(values);
+	}
+	else if (key == "range")
+	{
+	    // range name min max, sampled by latin hypercube
+	    std::string name;
+	    float a, b;
+	    in >> name >> a >> b;
+	    rangeNames.push_back(name);
+	    rangeMin.push_back(a);
+	    rangeMax.push_back(b);
+	}
+	else if (key == "measure")
+	{
+	    std::string name;
+	    while (in >> name)
+		measures.push_back(name);
+	    in.clear();
+	}
+	else if (key == "samples") in >> samples;
+	else if (key == "seeds") in >> seeds;
+	else if (key == "seed") in >> seed;
+	else if (key == "output") in >> outputFilename;
+	else if (key == "warmup") in >> warmup;
+	else
+	{
+	    std::cerr << "Sweep : unknown key " << key << " in " << filename << std::endl;
+	    return false;
+	}
+
+	if (in.fail())
+	{
+	    std::cerr << "Sweep : malformed line '" << line << "' in " << filename << std::endl;
+	    return false;
+	}
+    }
+
+    return true;
+}
+
+std::vector<std::string> Sweep::names ()
+{
+    std::vector<std::string> n = gridNames;
+    n.insert(n.end(), rangeNames.begin(), rangeNames.end());
+    return n;
+}
+
+std::vector<std::vector<float> > Sweep::points ()
+{
+    // cartesian product of the grid values
+    std::vector<std::vector<float> > grid (1);
+    for (unsigned int d = 0; d < gridValues.size(); d++)
+    {
+	std::vector<std::vector<float> > expanded;
+	for (auto& p : grid)
+	    for (float v : gridValues[d])
+	    {
+		expanded.push_back(p);
+		expanded.back().push_back(v);
+	    }
+	grid.swap(expanded);
+    }
+
+    if (rangeNames.empty())
+	return grid;
+
+    // latin hypercube : each range is cut in as many strata as samples,
+    // every stratum is used exactly once per dimension
+    gsl_rng* random = gsl_rng_alloc(gsl_rng_mt19937);
+    gsl_rng_set(random, seed);
+
+    std::vector<std::vector<float> > lhs (samples, std::vector<float> (rangeNames.size()));
+    for (unsigned int d = 0; d < rangeNames.size(); d++)
+    {
+	std::vector<int> strata (samples);
+	for (int k = 0; k < samples; k++)
+	    strata[k] = k;
+	gsl_ran_shuffle(random, strata.data(), samples, sizeof(int));
+
+	for (int k = 0; k < samples; k++)
+	{
+	    float u = (strata[k] + gsl_rng_uniform(random)) / samples;
+	    lhs[k][d] = rangeMin[d] + u * (rangeMax[d] - rangeMin[d]);
+	}
+    }
+    gsl_rng_free(random);
+
+    std::vector<std::vector<float> > result;
+    for (auto& g : grid)
+	for (auto& l : lhs)
+	{
+	    result.push_back(g);
+	    result.back().insert(result.back().end(), l.begin(), l.end());
+	}
+
+    return result;
+}
+
+bool Sweep::run (Run run, ProcessPool& pool)
+{
+    std::ofstream file (outputFilename.c_str());
+    if (!file.good())
+    {
+	std::cerr << "Sweep : cannot write " << outputFilename << std::endl;
+	return false;
+    }
+
+    std::vector<std::string> n = names();
+    std::vector<std::vector<float> > p = points();
+
+    // one column per parameter and per measure
+    file << "point,seed";
+    for (auto& name : n)
+	file << "," << name;
+    file << ",wallTime";
+    for (auto& m : measures)
+	file << "," << m;
+    file << std::endl;
+    file.precision(9);
+
+    int total = p.size() * seeds;
+    int submitted = 0;
+    int done = 0;
+    std::map<int, int> jobs;
+
+    std::cout << "Sweep : " << p.size() << " points x " << seeds << " seeds on " << pool.workers << " workers" << std::endl;
+
+    while (done < total)
+    {
+	// keep every worker busy
+	while (!pool.full() && submitted < total)
+	{
+	    int job = submitted++;
+	    std::vector<float> point = p[job / seeds];
+	    long int s = job % seeds + 1;
+
+	    int id = pool.submit([run, point, s] () {
+		    timeval start, end;
+		    gettimeofday(&start, NULL);
+		    std::vector<float> result = run(point, s);
+		    gettimeofday(&end, NULL);
+
+		    float wall = (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) * 1e-6;
+		    result.insert(result.begin(), wall);
+		    return result;
+		});
+	    if (id < 0)
+	    {
+		std::cerr << "Sweep : cannot start run" << std::endl;
+		return false;
+	    }
+	    jobs[id] = job;
+	}
+
+	int id;
+	std::vector<float> result;
+	if (!pool.wait(id, result))
+	    return false;
+
+	auto j = jobs.find(id);
+	if (j == jobs.end())
+	    continue;
+	int job = j->second;
+	jobs.erase(j);
+	done++;
+
+	// a failed run leaves its measures empty
+	file << job / seeds << "," << job % seeds + 1;
+	for (float v : p[job / seeds])
+	    file << "," << v;
+	for (unsigned int k = 0; k < measures.size() + 1; k++)
+	{
+	    file << ",";
+	    if (k < result.size())
+		file << result[k];
+	}
+	file << std::endl;
+
+	if (done % 100 == 0 || done == total)
+	    std::cout << "Sweep : " << done << " / " << total << " runs" << std::endl;
+    }
+
+    return true;
+}
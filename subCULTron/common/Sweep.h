@@ -0,0 +1,68 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+class ProcessPool;
+
+// Parameter sweep over registered parameters. Points are the cartesian
+// product of the grid values, crossed with a latin hypercube sample of the
+// ranges. Every point is run for every seed in a ProcessPool and one line
+// per run is appended to a CSV file.
+//
+// With a warmup time, the experiment is built and run once up to that time,
+// then every run is a branch forked from the warmed-up process : memory is
+// shared copy-on-write and only the state a branch modifies is duplicated.
+// Branch parameters are changed in place, so only those read while running
+// (controller parameters, thresholds) have an effect.
+class Sweep
+{
+public :
+    // runs one replicate for a point and a seed, returns the measures
+    typedef std::function<std::vector<float>(const std::vector<float>&, long int)> Run;
+
+    // specification
+    std::vector<std::string> gridNames;
+    std::vector<std::vector<float> > gridValues;
+    std::vector<std::string> rangeNames;
+    std::vector<float> rangeMin;
+    std::vector<float> rangeMax;
+    int samples = 10;
+    int seeds = 1;
+    long int seed = 1;
+    std::vector<std::string> measures;
+    std::string outputFilename = "sweep.csv";
+    float warmup = 0.0;
+
+    // methods
+    bool load (const std::string& filename);
+
+    std::vector<std::string> names ();
+    std::vector<std::vector<float> > points ();
+
+    bool run (Run run, ProcessPool& pool);
+};
+
+
+#endif
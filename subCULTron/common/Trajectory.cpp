@@ -0,0 +1,191 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#include "Trajectory.h"
+
+#include <cstring>
+
+#include <zlib.h>
+
+
+// little endian fields, each call moves the cursor past the field
+static void put (unsigned char*& out, uint64_t value, int bytes)
+{
+    for (int b = 0; b < bytes; b++)
+	*out++ = (value >> (8 * b)) & 0xff;
+}
+
+static void put (unsigned char*& out, float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    put(out, bits, 4);
+}
+
+static uint64_t get (const unsigned char*& in, int bytes)
+{
+    uint64_t value = 0;
+    for (int b = 0; b < bytes; b++)
+	value |= uint64_t(*in++) << (8 * b);
+    return value;
+}
+
+static float getFloat (const unsigned char*& in)
+{
+    uint32_t bits = get(in, 4);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void trajectoryPack (const TrajectoryHeader& header, unsigned char* out)
+{
+    memcpy(out, header.magic, 4);
+    out += 4;
+    put(out, header.version, 4);
+    put(out, header.agentCount, 4);
+    put(out, header.channelCount, 4);
+    put(out, header.period);
+}
+
+void trajectoryPack (const TrajectoryChunk& chunk, unsigned char* out)
+{
+    put(out, chunk.sampleCount, 4);
+    put(out, chunk.startTime);
+    put(out, chunk.endTime);
+    put(out, chunk.rawSize, 4);
+    put(out, chunk.compressedSize, 4);
+    put(out, chunk.eventCount, 4);
+    put(out, chunk.eventSize, 4);
+}
+
+void trajectoryPack (const TrajectoryIndexEntry& entry, unsigned char* out)
+{
+    put(out, entry.offset, 8);
+    put(out, entry.startTime);
+    put(out, entry.endTime);
+    put(out, entry.sampleCount, 4);
+}
+
+void trajectoryPack (const TrajectoryFooter& footer, unsigned char* out)
+{
+    put(out, footer.indexOffset, 8);
+    put(out, footer.chunkCount, 4);
+    memcpy(out, footer.magic, 4);
+}
+
+void trajectoryPack (uint32_t value, unsigned char* out)
+{
+    put(out, value, 4);
+}
+
+void trajectoryUnpack (const unsigned char* in, TrajectoryHeader& header)
+{
+    memcpy(header.magic, in, 4);
+    in += 4;
+    header.version = get(in, 4);
+    header.agentCount = get(in, 4);
+    header.channelCount = get(in, 4);
+    header.period = getFloat(in);
+}
+
+void trajectoryUnpack (const unsigned char* in, TrajectoryChunk& chunk)
+{
+    chunk.sampleCount = get(in, 4);
+    chunk.startTime = getFloat(in);
+    chunk.endTime = getFloat(in);
+    chunk.rawSize = get(in, 4);
+    chunk.compressedSize = get(in, 4);
+    chunk.eventCount = get(in, 4);
+    chunk.eventSize = get(in, 4);
+}
+
+void trajectoryUnpack (const unsigned char* in, TrajectoryIndexEntry& entry)
+{
+    entry.offset = get(in, 8);
+    entry.startTime = getFloat(in);
+    entry.endTime = getFloat(in);
+    entry.sampleCount = get(in, 4);
+}
+
+void trajectoryUnpack (const unsigned char* in, TrajectoryFooter& footer)
+{
+    footer.indexOffset = get(in, 8);
+    footer.chunkCount = get(in, 4);
+    memcpy(footer.magic, in, 4);
+}
+
+void trajectoryUnpack (const unsigned char* in, uint32_t& value)
+{
+    value = get(in, 4);
+}
+
+bool trajectoryEncode (const std::vector<float>& raw, int sampleCount, int level, std::vector<unsigned char>& out)
+{
+    if (sampleCount <= 0)
+	return false;
+
+    size_t n = raw.size();
+    std::vector<uint32_t> bits (n);
+    memcpy(bits.data(), raw.data(), n * sizeof(float));
+
+    // slowly varying columns give small deltas, backwards to stay in place
+    for (size_t c = 0; c + sampleCount <= n; c += sampleCount)
+	for (int i = sampleCount - 1; i > 0; i--)
+	    bits[c + i] -= bits[c + i - 1];
+
+    // small deltas have zero high bytes : group bytes by significance
+    std::vector<unsigned char> shuffled (n * 4);
+    for (size_t i = 0; i < n; i++)
+	for (int b = 0; b < 4; b++)
+	    shuffled[b * n + i] = (bits[i] >> (8 * b)) & 0xff;
+
+    uLongf size = compressBound(shuffled.size());
+    out.resize(size);
+    if (compress2(out.data(), &size, shuffled.data(), shuffled.size(), level) != Z_OK)
+	return false;
+    out.resize(size);
+
+    return true;
+}
+
+bool trajectoryDecode (const unsigned char* in, size_t size, int sampleCount, std::vector<float>& raw)
+{
+    if (sampleCount <= 0)
+	return false;
+
+    size_t n = raw.size();
+    std::vector<unsigned char> shuffled (n * 4);
+    uLongf length = shuffled.size();
+    if (uncompress(shuffled.data(), &length, in, size) != Z_OK || length != shuffled.size())
+	return false;
+
+    std::vector<uint32_t> bits (n, 0);
+    for (size_t i = 0; i < n; i++)
+	for (int b = 0; b < 4; b++)
+	    bits[i] |= uint32_t(shuffled[b * n + i]) << (8 * b);
+
+    for (size_t c = 0; c + sampleCount <= n; c += sampleCount)
+	for (int i = 1; i < sampleCount; i++)
+	    bits[c + i] += bits[c + i - 1];
+
+    memcpy(raw.data(), bits.data(), n * sizeof(float));
+
+    return true;
+}
@@ -0,0 +1,118 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#ifndef TRAJECTORY_H
+#define TRAJECTORY_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Trajectory file layout, shared by the recorder and the reader.
+//
+//   TrajectoryHeader, then channelCount names (uint32 length + characters)
+//   chunks : TrajectoryChunk, compressed samples, text events
+//   index : one TrajectoryIndexEntry per chunk
+//   TrajectoryFooter
+//
+// A chunk holds sampleCount consecutive samples as columns : first the
+// sample times, then one column per channel and agent (channel major). Each
+// column is delta coded on the float bit patterns, bytes are regrouped by
+// significance and the result is deflated. Text events are the texts that
+// changed since the previous sample : uint32 sample, uint32 agent, uint32
+// length and characters.
+//
+// Records are stored field by field, little endian and without padding,
+// whatever the layout of the structures below on the host : use the pack
+// and unpack functions, with the sizes given here.
+
+#define TRAJECTORY_MAGIC "FTRJ"
+#define TRAJECTORY_INDEX_MAGIC "FTRI"
+#define TRAJECTORY_VERSION 2
+
+struct TrajectoryHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t agentCount;
+    uint32_t channelCount;
+    float period;
+};
+
+struct TrajectoryChunk
+{
+    uint32_t sampleCount;
+    float startTime;
+    float endTime;
+    uint32_t rawSize;
+    uint32_t compressedSize;
+    uint32_t eventCount;
+    uint32_t eventSize;
+};
+
+struct TrajectoryIndexEntry
+{
+    uint64_t offset;
+    float startTime;
+    float endTime;
+    uint32_t sampleCount;
+};
+
+struct TrajectoryFooter
+{
+    uint64_t indexOffset;
+    uint32_t chunkCount;
+    char magic[4];
+};
+
+static const size_t trajectoryHeaderSize = 20;
+static const size_t trajectoryChunkSize = 28;
+static const size_t trajectoryIndexEntrySize = 20;
+static const size_t trajectoryFooterSize = 16;
+static const size_t trajectoryEventSize = 12;
+
+void trajectoryPack (const TrajectoryHeader& header, unsigned char* out);
+void trajectoryPack (const TrajectoryChunk& chunk, unsigned char* out);
+void trajectoryPack (const TrajectoryIndexEntry& entry, unsigned char* out);
+void trajectoryPack (const TrajectoryFooter& footer, unsigned char* out);
+void trajectoryPack (uint32_t value, unsigned char* out);
+void trajectoryUnpack (const unsigned char* in, TrajectoryHeader& header);
+void trajectoryUnpack (const unsigned char* in, TrajectoryChunk& chunk);
+void trajectoryUnpack (const unsigned char* in, TrajectoryIndexEntry& entry);
+void trajectoryUnpack (const unsigned char* in, TrajectoryFooter& footer);
+void trajectoryUnpack (const unsigned char* in, uint32_t& value);
+
+// built-in channels, recorded for every agent
+static const char* const trajectoryChannels[] =
+{
+    "x", "y", "z",
+    "qx", "qy", "qz", "qw",
+    "vx", "vy", "vz",
+    "red", "green", "blue", "alpha",
+    "state"
+};
+static const int trajectoryChannelCount = sizeof(trajectoryChannels) / sizeof(trajectoryChannels[0]);
+
+// column coding of a chunk, raw holds columns of sampleCount values and is
+// sized by the caller when decoding
+bool trajectoryEncode (const std::vector<float>& raw, int sampleCount, int level, std::vector<unsigned char>& out);
+bool trajectoryDecode (const unsigned char* in, size_t size, int sampleCount, std::vector<float>& raw);
+
+
+#endif
@@ -0,0 +1,123 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#include "TrajectoryLibrary.h"
+#include "TrajectoryReader.h"
+
+#include <algorithm>
+#include <cstring>
+
+
+// the reader keeps the channel names, the handle only adds the buffers
+// used to hand results over to C
+struct TrajectoryHandle
+{
+    TrajectoryReader reader;
+    std::string name;
+    std::vector<float> times;
+    std::vector<float> values;
+};
+
+static TrajectoryReader& reader (void* handle)
+{
+    return ((TrajectoryHandle*) handle)->reader;
+}
+
+void* trajectory_open (const char* filename)
+{
+    TrajectoryHandle* handle = new TrajectoryHandle;
+    if (!filename || !handle->reader.open(filename))
+    {
+	delete handle;
+	return NULL;
+    }
+
+    return handle;
+}
+
+void trajectory_close (void* handle)
+{
+    delete (TrajectoryHandle*) handle;
+}
+
+int trajectory_agent_count (void* handle)
+{
+    return reader(handle).agentCount();
+}
+
+int trajectory_channel_count (void* handle)
+{
+    return reader(handle).channelCount();
+}
+
+const char* trajectory_channel_name (void* handle, int channel)
+{
+    TrajectoryHandle* h = (TrajectoryHandle*) handle;
+    h->name = h->reader.channelName(channel);
+    return h->name.c_str();
+}
+
+int trajectory_channel (void* handle, const char* name)
+{
+    return reader(handle).channel(name);
+}
+
+float trajectory_period (void* handle)
+{
+    return reader(handle).period();
+}
+
+float trajectory_start_time (void* handle)
+{
+    return reader(handle).startTime();
+}
+
+float trajectory_end_time (void* handle)
+{
+    return reader(handle).endTime();
+}
+
+int trajectory_count (void* handle, float start, float end)
+{
+    return reader(handle).count(start, end);
+}
+
+int trajectory_extract (void* handle, float start, float end,
+			const int* agents, int agentCount, const int* channels, int channelCount,
+			float* times, float* values, int capacity)
+{
+    TrajectoryHandle* h = (TrajectoryHandle*) handle;
+
+    // out of range selections are refused rather than read past the chunk
+    for (int i = 0; i < agentCount; i++)
+	if (agents[i] < 0 || agents[i] >= h->reader.agentCount())
+	    return -1;
+    for (int i = 0; i < channelCount; i++)
+	if (channels[i] < 0 || channels[i] >= h->reader.channelCount())
+	    return -1;
+
+    std::vector<int> a (agents, agents + agentCount);
+    std::vector<int> c (channels, channels + channelCount);
+    int n = std::min(h->reader.extract(start, end, a, c, h->times, h->values), capacity);
+
+    memcpy(times, h->times.data(), n * sizeof(float));
+    memcpy(values, h->values.data(), (size_t) n * agentCount * channelCount * sizeof(float));
+
+    return n;
+}
@@ -0,0 +1,56 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#ifndef TRAJECTORY_LIBRARY_H
+#define TRAJECTORY_LIBRARY_H
+
+/* C interface of TrajectoryReader, built as libtrajectory by the premake
+   script of this directory and used from python by trajectory.py. Handles
+   are returned by trajectory_open, NULL when the file cannot be read. */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void* trajectory_open (const char* filename);
+void trajectory_close (void* handle);
+
+int trajectory_agent_count (void* handle);
+int trajectory_channel_count (void* handle);
+const char* trajectory_channel_name (void* handle, int channel);
+int trajectory_channel (void* handle, const char* name);
+float trajectory_period (void* handle);
+float trajectory_start_time (void* handle);
+float trajectory_end_time (void* handle);
+
+/* number of samples with start <= time <= end, to size the buffers */
+int trajectory_count (void* handle, float start, float end);
+
+/* writes at most capacity samples : times[capacity] and
+   values[capacity][agentCount][channelCount], returns the number written */
+int trajectory_extract (void* handle, float start, float end,
+			const int* agents, int agentCount, const int* channels, int channelCount,
+			float* times, float* values, int capacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
@@ -0,0 +1,178 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#include "TrajectoryPlayer.h"
+#include "Appearance.h"
+
+#include "Simulator.h"
+#include "Object.h"
+#ifndef HEADLESS
+#include "RenderOSG.h"
+
+#include <osgGA/GUIEventHandler>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+TrajectoryPlayer* TrajectoryPlayer::replay = NULL;
+
+
+#ifndef HEADLESS
+// playback controls, in the render window
+class TrajectoryPlayerKeys : public osgGA::GUIEventHandler
+{
+public :
+    TrajectoryPlayerKeys (TrajectoryPlayer* player) : player (player) {}
+
+    bool handle (const osgGA::GUIEventAdapter& ea, osgGA::GUIActionAdapter& aa)
+    {
+	if (ea.getEventType() != osgGA::GUIEventAdapter::KEYDOWN)
+	    return false;
+
+	switch (ea.getKey())
+	{
+	case '+': case '=': player->setSpeed(player->speed * 2.0); return true;
+	case '-': player->setSpeed(player->speed / 2.0); return true;
+	case '0': player->setSpeed(1.0); return true;
+	case osgGA::GUIEventAdapter::KEY_Right: player->seek(player->current() + 10.0); return true;
+	case osgGA::GUIEventAdapter::KEY_Left: player->seek(player->current() - 10.0); return true;
+	case osgGA::GUIEventAdapter::KEY_Page_Up: player->seek(player->current() + 60.0); return true;
+	case osgGA::GUIEventAdapter::KEY_Page_Down: player->seek(player->current() - 60.0); return true;
+	case osgGA::GUIEventAdapter::KEY_Home: player->seek(0.0); return true;
+	}
+
+	return false;
+    }
+
+private :
+    TrajectoryPlayer* player;
+};
+#endif
+
+TrajectoryPlayer::TrajectoryPlayer () :
+    TrajectoryRecorder ("", 0.0)
+{
+    ready = false;
+    failed = false;
+    time = 0.0;
+    clock = 0.0;
+    shown = NAN;
+}
+
+bool TrajectoryPlayer::open (const std::string& filename)
+{
+    if (!reader.open(filename))
+	return false;
+
+    time = reader.startTime();
+    setTimestep(reader.period());
+
+    return true;
+}
+
+void TrajectoryPlayer::attach (RenderOSG* render)
+{
+#ifndef HEADLESS
+    if (render)
+	render->viewer->addEventHandler(new TrajectoryPlayerKeys (this));
+#endif
+}
+
+float TrajectoryPlayer::current ()
+{
+    return time;
+}
+
+void TrajectoryPlayer::seek (float time)
+{
+    this->time = std::min(std::max(time, reader.startTime()), reader.endTime());
+    shown = NAN;
+
+    std::cout << "Replay : time " << this->time << std::endl;
+}
+
+void TrajectoryPlayer::setSpeed (float speed)
+{
+    this->speed = speed;
+
+    std::cout << "Replay : speed x" << speed << std::endl;
+}
+
+void TrajectoryPlayer::start ()
+{
+    ready = true;
+    clock = simulator->time;
+
+    if ((int) agents.size() != reader.agentCount())
+    {
+	std::cerr << "TrajectoryPlayer : the file holds " << reader.agentCount() << " agents, the experiment "
+		  << agents.size() << ", check the parameters given with --set" << std::endl;
+	failed = true;
+	return;
+    }
+
+    // the file drives the agents, nothing else may move or colour them
+    for (Object* object : agents)
+    {
+	object->body->setLinearVelocity(btVector3(0,0,0));
+	object->body->setAngularVelocity(btVector3(0,0,0));
+	object->body->forceActivationState(DISABLE_SIMULATION);
+	object->controllers.clear();
+    }
+}
+
+void TrajectoryPlayer::step ()
+{
+    if (!ready)
+	start();
+    if (failed)
+	return;
+
+    time = std::min(time + (simulator->time - clock) * speed, reader.endTime());
+    clock = simulator->time;
+
+    // samples are held until the next one, nothing to do in between
+    float t = reader.frame(time, values);
+    if (values.empty() || t == shown)
+	return;
+    shown = t;
+
+    // built-in channels, in the order of trajectoryChannels
+    int c = reader.channelCount();
+    for (unsigned int a = 0; a < agents.size(); a++)
+    {
+	const float* v = &values[a * c];
+	btTransform transform (btQuaternion(v[3], v[4], v[5], v[6]), btVector3(v[0], v[1], v[2]));
+
+	btRigidBody* body = agents[a]->body;
+	body->setWorldTransform(transform);
+	body->setInterpolationWorldTransform(transform);
+	if (body->getMotionState())
+	    body->getMotionState()->setWorldTransform(transform);
+
+	Appearance::setColor(agents[a], v[10], v[11], v[12], v[13]);
+    }
+
+    reader.texts(t, texts);
+    for (unsigned int a = 0; a < agents.size(); a++)
+	if (texts[a] != Appearance::get(agents[a]).text)
+	    Appearance::setText(agents[a], texts[a]);
+}
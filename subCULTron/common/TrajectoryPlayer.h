@@ -0,0 +1,79 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#ifndef TRAJECTORY_PLAYER_H
+#define TRAJECTORY_PLAYER_H
+
+#include "TrajectoryRecorder.h"
+#include "TrajectoryReader.h"
+
+#include <string>
+#include <vector>
+
+class RenderOSG;
+
+// Replays a recorded run in the scene built by the experiment. The player
+// stands in for the recorder (see TrajectoryRecorder::create), so the
+// experiment lists its agents in the order they were recorded. Their bodies
+// are taken out of the physics and their controllers are dropped : poses,
+// colours and texts come from the file only. The experiments do not add
+// the physics and the water volume to the simulator when replaying, so the
+// world is built for the render but not simulated.
+//
+// Keys : + and - change the speed, 0 restores it, left and right arrows
+// seek by 10 s, page up and down by 60 s, home goes back to the start.
+class TrajectoryPlayer : public TrajectoryRecorder
+{
+public :
+    // set by the launcher before the experiment is built
+    static TrajectoryPlayer* replay;
+
+    // parameters
+    float speed = 1.0;
+
+    // methods
+    TrajectoryPlayer ();
+
+    bool open (const std::string& filename);
+    void attach (RenderOSG* render);
+
+    float current ();
+    void seek (float time);
+    void setSpeed (float speed);
+
+    void step ();
+
+private :
+    TrajectoryReader reader;
+    bool ready;
+    bool failed;
+
+    // playback time, advanced by the simulated time elapsed times speed
+    float time;
+    float clock;
+    float shown;
+
+    std::vector<float> values;
+    std::vector<std::string> texts;
+
+    void start ();
+};
+
+
+#endif
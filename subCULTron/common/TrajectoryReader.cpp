@@ -0,0 +1,429 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#include "TrajectoryReader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+TrajectoryReader::TrajectoryReader ()
+{
+    fd = -1;
+    data = NULL;
+    size = 0;
+    cachedChunk = -1;
+    memset(&header, 0, sizeof(header));
+}
+
+TrajectoryReader::~TrajectoryReader ()
+{
+    close();
+}
+
+bool TrajectoryReader::open (const std::string& filename)
+{
+    close();
+
+    fd = ::open(filename.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0)
+    {
+	std::cerr << "TrajectoryReader : cannot read " << filename << std::endl;
+	close();
+	return false;
+    }
+
+    size = st.st_size;
+    void* p = size > 0 ? mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    if (p == MAP_FAILED)
+    {
+	std::cerr << "TrajectoryReader : cannot map " << filename << std::endl;
+	close();
+	return false;
+    }
+    data = (const unsigned char*) p;
+
+    if (size < trajectoryHeaderSize
+	|| (trajectoryUnpack(data, header), memcmp(header.magic, TRAJECTORY_MAGIC, 4) != 0)
+	|| header.version != TRAJECTORY_VERSION)
+    {
+	std::cerr << "TrajectoryReader : " << filename << " is not a trajectory of this version" << std::endl;
+	close();
+	return false;
+    }
+
+    // channel names
+    size_t offset = trajectoryHeaderSize;
+    for (unsigned int k = 0; k < header.channelCount; k++)
+    {
+	uint32_t length;
+	if (offset + sizeof(length) > size)
+	    break;
+	trajectoryUnpack(data + offset, length);
+	offset += sizeof(length);
+	if (offset + length > size)
+	    break;
+	names.push_back(std::string ((const char*) data + offset, length));
+	offset += length;
+    }
+    if (names.size() != header.channelCount)
+    {
+	std::cerr << "TrajectoryReader : " << filename << " is truncated" << std::endl;
+	close();
+	return false;
+    }
+
+    // index written at close, or rebuilt from the chunks
+    TrajectoryFooter footer;
+    bool indexed = false;
+    if (size >= offset + trajectoryFooterSize)
+    {
+	trajectoryUnpack(data + size - trajectoryFooterSize, footer);
+	size_t indexSize = footer.chunkCount * trajectoryIndexEntrySize;
+	if (memcmp(footer.magic, TRAJECTORY_INDEX_MAGIC, 4) == 0
+	    && footer.indexOffset >= offset
+	    && footer.indexOffset + indexSize + trajectoryFooterSize == size)
+	{
+	    index.resize(footer.chunkCount);
+	    for (unsigned int i = 0; i < footer.chunkCount; i++)
+		trajectoryUnpack(data + footer.indexOffset + i * trajectoryIndexEntrySize, index[i]);
+
+	    // entries must point at readable chunks before the index
+	    indexed = true;
+	    for (const TrajectoryIndexEntry& entry : index)
+	    {
+		size_t total = entry.offset >= offset ? chunkSize(entry.offset) : 0;
+		if (total == 0 || entry.offset + total > footer.indexOffset)
+		{
+		    indexed = false;
+		    break;
+		}
+
+		TrajectoryChunk chunk;
+		trajectoryUnpack(data + entry.offset, chunk);
+		if (chunk.sampleCount != entry.sampleCount)
+		{
+		    indexed = false;
+		    break;
+		}
+	    }
+	    if (!indexed)
+		index.clear();
+	}
+    }
+    if (!indexed && !scan(offset))
+    {
+	std::cerr << "TrajectoryReader : " << filename << " has no index and no readable chunk" << std::endl;
+	close();
+	return false;
+    }
+
+    return true;
+}
+
+// bytes taken by a well formed chunk starting at offset, 0 otherwise
+size_t TrajectoryReader::chunkSize (size_t offset)
+{
+    if (offset > size || size - offset < trajectoryChunkSize)
+	return 0;
+
+    TrajectoryChunk chunk;
+    trajectoryUnpack(data + offset, chunk);
+
+    size_t columns = 1 + header.channelCount * header.agentCount;
+    size_t total = trajectoryChunkSize + chunk.compressedSize + chunk.eventSize;
+    if (offset + total > size || chunk.sampleCount == 0
+	|| chunk.rawSize != columns * chunk.sampleCount * sizeof(float))
+	return 0;
+
+    return total;
+}
+
+bool TrajectoryReader::scan (size_t offset)
+{
+    while (size_t total = chunkSize(offset))
+    {
+	TrajectoryChunk chunk;
+	trajectoryUnpack(data + offset, chunk);
+
+	TrajectoryIndexEntry entry;
+	entry.offset = offset;
+	entry.startTime = chunk.startTime;
+	entry.endTime = chunk.endTime;
+	entry.sampleCount = chunk.sampleCount;
+	index.push_back(entry);
+
+	offset += total;
+    }
+
+    return !index.empty();
+}
+
+void TrajectoryReader::close ()
+{
+    if (data)
+	munmap((void*) data, size);
+    if (fd >= 0)
+	::close(fd);
+
+    fd = -1;
+    data = NULL;
+    size = 0;
+    names.clear();
+    index.clear();
+    cachedChunk = -1;
+    cache.clear();
+    textCheckpoints.clear();
+}
+
+int TrajectoryReader::agentCount ()
+{
+    return header.agentCount;
+}
+
+int TrajectoryReader::channelCount ()
+{
+    return header.channelCount;
+}
+
+std::string TrajectoryReader::channelName (int channel)
+{
+    if (channel < 0 || channel >= (int) names.size())
+	return "";
+
+    return names[channel];
+}
+
+int TrajectoryReader::channel (const std::string& name)
+{
+    auto it = std::find(names.begin(), names.end(), name);
+    if (it == names.end())
+	return -1;
+
+    return it - names.begin();
+}
+
+float TrajectoryReader::period ()
+{
+    return header.period;
+}
+
+int TrajectoryReader::chunkCount ()
+{
+    return index.size();
+}
+
+int TrajectoryReader::sampleCount ()
+{
+    int n = 0;
+    for (auto& e : index)
+	n += e.sampleCount;
+
+    return n;
+}
+
+float TrajectoryReader::startTime ()
+{
+    return index.empty() ? 0.0 : index.front().startTime;
+}
+
+float TrajectoryReader::endTime ()
+{
+    return index.empty() ? 0.0 : index.back().endTime;
+}
+
+int TrajectoryReader::firstChunk (float start)
+{
+    // first chunk ending at or after start
+    auto it = std::lower_bound(index.begin(), index.end(), start,
+			       [] (const TrajectoryIndexEntry& e, float t) { return e.endTime < t; });
+    return it - index.begin();
+}
+
+const std::vector<float>& TrajectoryReader::decode (int chunk)
+{
+    if (chunk == cachedChunk)
+	return cache;
+
+    TrajectoryChunk c;
+    size_t offset = index[chunk].offset;
+    trajectoryUnpack(data + offset, c);
+
+    cache.resize(c.rawSize / sizeof(float));
+    if (!trajectoryDecode(data + offset + trajectoryChunkSize, c.compressedSize, c.sampleCount, cache))
+    {
+	std::cerr << "TrajectoryReader : chunk " << chunk << " is corrupted" << std::endl;
+	cache.clear();
+    }
+    cachedChunk = chunk;
+
+    return cache;
+}
+
+int TrajectoryReader::count (float start, float end)
+{
+    int n = 0;
+    for (int k = firstChunk(start); k < (int) index.size() && index[k].startTime <= end; k++)
+    {
+	// whole chunks are counted from the index alone
+	if (index[k].startTime >= start && index[k].endTime <= end)
+	{
+	    n += index[k].sampleCount;
+	    continue;
+	}
+
+	const std::vector<float>& raw = decode(k);
+	if (raw.empty())
+	    continue;
+	for (unsigned int s = 0; s < index[k].sampleCount; s++)
+	    if (raw[s] >= start && raw[s] <= end)
+		n++;
+    }
+
+    return n;
+}
+
+int TrajectoryReader::extract (float start, float end, const std::vector<int>& agents, const std::vector<int>& channels,
+			       std::vector<float>& times, std::vector<float>& values)
+{
+    times.clear();
+    values.clear();
+
+    int a = header.agentCount;
+    for (int k = firstChunk(start); k < (int) index.size() && index[k].startTime <= end; k++)
+    {
+	const std::vector<float>& raw = decode(k);
+	if (raw.empty())
+	    continue;
+
+	int n = index[k].sampleCount;
+	for (int s = 0; s < n; s++)
+	{
+	    if (raw[s] < start || raw[s] > end)
+		continue;
+
+	    times.push_back(raw[s]);
+	    for (int agent : agents)
+		for (int channel : channels)
+		    values.push_back(raw[(1 + channel * a + agent) * n + s]);
+	}
+    }
+
+    return times.size();
+}
+
+float TrajectoryReader::frame (float time, std::vector<float>& values)
+{
+    values.clear();
+    if (index.empty())
+	return 0.0;
+
+    // chunk holding time, or the one before when time falls in between
+    int k = firstChunk(time);
+    if (k == (int) index.size() || (index[k].startTime > time && k > 0))
+	k--;
+
+    const std::vector<float>& raw = decode(k);
+    if (raw.empty())
+	return 0.0;
+
+    int n = index[k].sampleCount;
+    int s = std::max(int(std::upper_bound(raw.begin(), raw.begin() + n, time) - raw.begin()) - 1, 0);
+
+    int a = header.agentCount;
+    int c = header.channelCount;
+    values.resize(a * c);
+    for (int agent = 0; agent < a; agent++)
+	for (int channel = 0; channel < c; channel++)
+	    values[agent * c + channel] = raw[(1 + channel * a + agent) * n + s];
+
+    return raw[s];
+}
+
+void TrajectoryReader::texts (float time, std::vector<std::string>& result)
+{
+    result.assign(header.agentCount, "");
+
+    // last chunk starting at or before time
+    int k = firstChunk(time);
+    if (k == (int) index.size() || index[k].startTime > time)
+	k--;
+    if (k < 0)
+	return;
+
+    // only the events of that chunk are walked, the earlier ones are
+    // summed up by the checkpoint at its start
+    if (textCheckpoints.empty())
+	textCheckpoints.push_back(result);
+    while ((int) textCheckpoints.size() <= k)
+    {
+	std::vector<std::string> next = textCheckpoints.back();
+	events(textCheckpoints.size() - 1, INFINITY, next);
+	textCheckpoints.push_back(next);
+    }
+
+    result = textCheckpoints[k];
+    events(k, time, result);
+}
+
+// applies the text events of a chunk up to time, false when the chunk
+// cannot be read
+bool TrajectoryReader::events (int chunk, float time, std::vector<std::string>& texts)
+{
+    TrajectoryChunk c;
+    size_t offset = index[chunk].offset;
+    trajectoryUnpack(data + offset, c);
+
+    // sample times are only needed when time falls in the chunk
+    const float* sampleTimes = NULL;
+    if (index[chunk].endTime > time)
+    {
+	const std::vector<float>& raw = decode(chunk);
+	if (raw.empty())
+	    return false;
+	sampleTimes = raw.data();
+    }
+
+    const unsigned char* e = data + offset + trajectoryChunkSize + c.compressedSize;
+    const unsigned char* eventsEnd = e + c.eventSize;
+    for (unsigned int i = 0; i < c.eventCount && e + trajectoryEventSize <= eventsEnd; i++)
+    {
+	uint32_t event[3];
+	for (int f = 0; f < 3; f++)
+	    trajectoryUnpack(e + 4 * f, event[f]);
+	e += trajectoryEventSize;
+	if (e + event[2] > eventsEnd)
+	    break;
+
+	// a sample outside the chunk is a corrupt event, skipped
+	if (event[0] < index[chunk].sampleCount && (!sampleTimes || sampleTimes[event[0]] <= time) && event[1] < header.agentCount)
+	    texts[event[1]] = std::string ((const char*) e, event[2]);
+	e += event[2];
+    }
+
+    return true;
+}
@@ -0,0 +1,90 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#ifndef TRAJECTORY_READER_H
+#define TRAJECTORY_READER_H
+
+#include "Trajectory.h"
+
+#include <string>
+#include <vector>
+
+// Reads a trajectory file written by TrajectoryRecorder. The file is memory
+// mapped and only the chunks overlapping the requested time range are
+// decompressed, found through the chunk index. Files left without an index
+// (interrupted run) are indexed by walking the chunks.
+class TrajectoryReader
+{
+public :
+    // methods
+    TrajectoryReader ();
+    ~TrajectoryReader ();
+
+    bool open (const std::string& filename);
+    void close ();
+
+    int agentCount ();
+    int channelCount ();
+    std::string channelName (int channel);
+    int channel (const std::string& name);
+    float period ();
+
+    int chunkCount ();
+    int sampleCount ();
+    float startTime ();
+    float endTime ();
+
+    // samples with start <= time <= end, values are stored sample major
+    // then agent then channel, returns the number of samples
+    int count (float start, float end);
+    int extract (float start, float end, const std::vector<int>& agents, const std::vector<int>& channels,
+		 std::vector<float>& times, std::vector<float>& values);
+
+    // latest sample at or before time (the first one before the start),
+    // values are stored agent major then channel, returns the sample time
+    float frame (float time, std::vector<float>& values);
+
+    // last text set for every agent at the given time
+    void texts (float time, std::vector<std::string>& result);
+
+private :
+    int fd;
+    const unsigned char* data;
+    size_t size;
+
+    TrajectoryHeader header;
+    std::vector<std::string> names;
+    std::vector<TrajectoryIndexEntry> index;
+
+    // last decoded chunk, replay and sequential reads hit it again
+    int cachedChunk;
+    std::vector<float> cache;
+
+    // texts in effect at the start of each chunk, filled as far as asked
+    std::vector<std::vector<std::string> > textCheckpoints;
+
+    size_t chunkSize (size_t offset);
+    bool scan (size_t offset);
+    int firstChunk (float start);
+    const std::vector<float>& decode (int chunk);
+    bool events (int chunk, float time, std::vector<std::string>& texts);
+};
+
+
+#endif
@@ -0,0 +1,286 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#include "TrajectoryRecorder.h"
+#include "TrajectoryPlayer.h"
+#include "Appearance.h"
+
+#include "Simulator.h"
+#include "Object.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+std::string TrajectoryRecorder::filename;
+
+
+TrajectoryRecorder* TrajectoryRecorder::create (float period)
+{
+    // experiments list their agents to the player as they would to a recorder
+    if (TrajectoryPlayer::replay)
+	return TrajectoryPlayer::replay;
+
+    if (filename.empty())
+	return NULL;
+
+    TrajectoryRecorder* recorder = new TrajectoryRecorder (filename, period);
+    recorder->setTimestep(period);
+
+    return recorder;
+}
+
+TrajectoryRecorder::TrajectoryRecorder (const std::string& filename, float period) :
+    head (0), tail (0), stopping (false)
+{
+    path = filename;
+    this->period = period;
+    file = NULL;
+    started = false;
+    closed = false;
+    failed = false;
+    current = NULL;
+}
+
+TrajectoryRecorder::~TrajectoryRecorder ()
+{
+    close();
+}
+
+void TrajectoryRecorder::add (Object* object, std::function<float()> state)
+{
+    agents.push_back(object);
+    states.push_back(state);
+    texts.push_back("");
+}
+
+void TrajectoryRecorder::start ()
+{
+    // agents are known once the simulation runs, header goes first
+    started = true;
+    file = fopen(path.c_str(), "wb");
+    if (!file)
+    {
+	std::cerr << "TrajectoryRecorder : cannot write " << path << std::endl;
+	closed = true;
+	failed = true;
+	return;
+    }
+
+    TrajectoryHeader header;
+    memcpy(header.magic, TRAJECTORY_MAGIC, 4);
+    header.version = TRAJECTORY_VERSION;
+    header.agentCount = agents.size();
+    header.channelCount = trajectoryChannelCount;
+    header.period = period;
+    unsigned char h[trajectoryHeaderSize];
+    trajectoryPack(header, h);
+    output(h, sizeof(h));
+
+    for (int k = 0; k < trajectoryChannelCount; k++)
+    {
+	unsigned char length[4];
+	trajectoryPack(uint32_t(strlen(trajectoryChannels[k])), length);
+	output(length, sizeof(length));
+	output(trajectoryChannels[k], strlen(trajectoryChannels[k]));
+    }
+
+    current = new Chunk;
+    current->data.resize((1 + trajectoryChannelCount * agents.size()) * samplesPerChunk);
+
+    writer = std::thread (&TrajectoryRecorder::write, this);
+}
+
+void TrajectoryRecorder::step ()
+{
+    if (!started)
+	start();
+    if (closed)
+	return;
+
+    Chunk* c = current;
+    int s = c->samples;
+    int n = agents.size();
+    float* data = c->data.data();
+
+    data[s] = simulator->time;
+    for (int a = 0; a < n; a++)
+    {
+	btRigidBody* body = agents[a]->body;
+	const btTransform& t = body->getCenterOfMassTransform();
+	btVector3 p = t.getOrigin();
+	btQuaternion q = t.getRotation();
+	btVector3 v = body->getLinearVelocity();
+	const Appearance::Look& look = Appearance::get(agents[a]);
+
+	float values[trajectoryChannelCount] = {
+	    p.x(), p.y(), p.z(),
+	    q.x(), q.y(), q.z(), q.w(),
+	    v.x(), v.y(), v.z(),
+	    look.color[0], look.color[1], look.color[2], look.color[3],
+	    states[a] ? states[a]() : NAN
+	};
+	for (int k = 0; k < trajectoryChannelCount; k++)
+	    data[(1 + k * n + a) * samplesPerChunk + s] = values[k];
+
+	// texts are rare, only changes are stored
+	if (look.text != texts[a])
+	{
+	    texts[a] = look.text;
+	    unsigned char event[trajectoryEventSize];
+	    trajectoryPack(uint32_t(s), event);
+	    trajectoryPack(uint32_t(a), event + 4);
+	    trajectoryPack(uint32_t(look.text.size()), event + 8);
+	    c->events.insert(c->events.end(), event, event + sizeof(event));
+	    c->events.insert(c->events.end(), look.text.begin(), look.text.end());
+	    c->eventCount++;
+	}
+    }
+
+    c->samples++;
+    if (c->samples == samplesPerChunk)
+    {
+	push(c);
+	current = new Chunk;
+	current->data.resize(c->data.size());
+    }
+}
+
+bool TrajectoryRecorder::close ()
+{
+    if (closed)
+	return !failed;
+    closed = true;
+    if (!started)
+	return true;
+
+    if (current->samples > 0)
+	push(current);
+    else
+	delete current;
+    current = NULL;
+
+    stopping.store(true, std::memory_order_release);
+    writer.join();
+
+    if (failed)
+	std::cerr << "TrajectoryRecorder : error while writing " << path << std::endl;
+    return !failed;
+}
+
+void TrajectoryRecorder::push (Chunk* chunk)
+{
+    // the writer is behind : wait rather than drop samples
+    unsigned int h = head.load(std::memory_order_relaxed);
+    while (h - tail.load(std::memory_order_acquire) >= queueSize)
+	std::this_thread::yield();
+
+    queue[h % queueSize] = chunk;
+    head.store(h + 1, std::memory_order_release);
+}
+
+void TrajectoryRecorder::write ()
+{
+    while (true)
+    {
+	unsigned int t = tail.load(std::memory_order_relaxed);
+	if (t != head.load(std::memory_order_acquire))
+	{
+	    Chunk* c = queue[t % queueSize];
+	    writeChunk(c);
+	    delete c;
+	    tail.store(t + 1, std::memory_order_release);
+	    continue;
+	}
+
+	// last chunk is pushed before stopping is set
+	if (stopping.load(std::memory_order_acquire))
+	{
+	    if (tail.load(std::memory_order_relaxed) == head.load(std::memory_order_acquire))
+		break;
+	    continue;
+	}
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    TrajectoryFooter footer;
+    footer.indexOffset = ftello(file);
+    footer.chunkCount = index.size();
+    memcpy(footer.magic, TRAJECTORY_INDEX_MAGIC, 4);
+
+    std::vector<unsigned char> entries (index.size() * trajectoryIndexEntrySize);
+    for (unsigned int i = 0; i < index.size(); i++)
+	trajectoryPack(index[i], &entries[i * trajectoryIndexEntrySize]);
+    unsigned char f[trajectoryFooterSize];
+    trajectoryPack(footer, f);
+    output(entries.data(), entries.size());
+    output(f, sizeof(f));
+
+    // reported by close, on the simulation thread
+    if (fclose(file) != 0)
+	failed = true;
+    file = NULL;
+}
+
+void TrajectoryRecorder::output (const void* p, size_t size)
+{
+    if (size > 0 && fwrite(p, 1, size, file) != size)
+	failed = true;
+}
+
+void TrajectoryRecorder::writeChunk (Chunk* c)
+{
+    // a partial chunk is compacted to columns of its own length
+    int columns = 1 + trajectoryChannelCount * agents.size();
+    std::vector<float> raw (columns * c->samples);
+    for (int k = 0; k < columns; k++)
+	memcpy(&raw[k * c->samples], &c->data[k * samplesPerChunk], c->samples * sizeof(float));
+
+    std::vector<unsigned char> compressed;
+    if (!trajectoryEncode(raw, c->samples, compressionLevel, compressed))
+    {
+	std::cerr << "TrajectoryRecorder : cannot compress chunk, dropped" << std::endl;
+	failed = true;
+	return;
+    }
+
+    TrajectoryIndexEntry entry;
+    entry.offset = ftello(file);
+    entry.startTime = raw[0];
+    entry.endTime = raw[c->samples - 1];
+    entry.sampleCount = c->samples;
+    index.push_back(entry);
+
+    TrajectoryChunk chunk;
+    chunk.sampleCount = c->samples;
+    chunk.startTime = entry.startTime;
+    chunk.endTime = entry.endTime;
+    chunk.rawSize = raw.size() * sizeof(float);
+    chunk.compressedSize = compressed.size();
+    chunk.eventCount = c->eventCount;
+    chunk.eventSize = c->events.size();
+
+    unsigned char h[trajectoryChunkSize];
+    trajectoryPack(chunk, h);
+    output(h, sizeof(h));
+    output(compressed.data(), compressed.size());
+    output(c->events.data(), c->events.size());
+}
@@ -0,0 +1,104 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#ifndef TRAJECTORY_RECORDER_H
+#define TRAJECTORY_RECORDER_H
+
+#include "Service.h"
+#include "Trajectory.h"
+
+#include <atomic>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+class Object;
+
+// Service sampling pose, velocity, colour and controller state of every
+// agent at its own timestep (see setTimestep). Samples are gathered in
+// chunks on the simulation thread; full chunks go through a lock free queue
+// to a writer thread which compresses and appends them to the file, see
+// Trajectory.h for the layout.
+class TrajectoryRecorder : public Service
+{
+public :
+    // output file given on the command line, recording is off when empty
+    static std::string filename;
+    // when replaying, create hands out the player instead (TrajectoryPlayer)
+    static TrajectoryRecorder* create (float period);
+
+    // parameters
+    int samplesPerChunk = 100;
+    int compressionLevel = 1;
+
+    // methods
+    TrajectoryRecorder (const std::string& filename, float period);
+    ~TrajectoryRecorder ();
+
+    void add (Object* object, std::function<float()> state = nullptr);
+
+    void step ();
+    // false when the file could not be written completely
+    bool close ();
+
+protected :
+    std::vector<Object*> agents;
+
+private :
+    // columns of samplesPerChunk values : times, then channels x agents
+    struct Chunk
+    {
+	std::vector<float> data;
+	std::vector<char> events;
+	uint32_t eventCount = 0;
+	int samples = 0;
+    };
+
+    std::string path;
+    float period;
+    FILE* file;
+    bool started;
+    bool closed;
+    bool failed;
+
+    std::vector<std::function<float()> > states;
+    std::vector<std::string> texts;
+    Chunk* current;
+
+    // single producer, single consumer ring of full chunks
+    static const int queueSize = 16;
+    Chunk* queue[queueSize];
+    std::atomic<unsigned int> head;
+    std::atomic<unsigned int> tail;
+    std::atomic<bool> stopping;
+    std::thread writer;
+
+    std::vector<TrajectoryIndexEntry> index;
+
+    void start ();
+    void push (Chunk* chunk);
+    void write ();
+    void writeChunk (Chunk* chunk);
+    void output (const void* p, size_t size);
+};
+
+
+#endif
@@ -0,0 +1,75 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+
+// Hands the latest state from one writer thread to one reader thread
+// without locks nor waiting : the writer fills back() then publishes it,
+// the reader takes the most recent published buffer, if any, with acquire()
+// and reads front() until the next one. Buffers are reused, states skipped
+// by a slow reader are simply overwritten.
+template <class T>
+class TripleBuffer
+{
+public :
+    TripleBuffer () : middle (1)
+    {
+	writing = 0;
+	reading = 2;
+    }
+
+    T& back ()
+    {
+	return buffers[writing];
+    }
+
+    void publish ()
+    {
+	writing = middle.exchange(writing | fresh, std::memory_order_acq_rel) & 3;
+    }
+
+    // true when a newer state is now in front()
+    bool acquire ()
+    {
+	if (!(middle.load(std::memory_order_relaxed) & fresh))
+	    return false;
+
+	reading = middle.exchange(reading, std::memory_order_acq_rel) & 3;
+	return true;
+    }
+
+    const T& front ()
+    {
+	return buffers[reading];
+    }
+
+private :
+    static const int fresh = 4;
+
+    T buffers[3];
+    int writing;
+    int reading;
+    std::atomic<int> middle;
+};
+
+
+#endif
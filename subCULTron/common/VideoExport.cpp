@@ -0,0 +1,319 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+// nothing is rendered in headless mode
+#ifndef HEADLESS
+
+#include "VideoExport.h"
+#include "Parameters.h"
+
+#include "Simulator.h"
+#include "RenderOSG.h"
+
+#include <osg/Camera>
+#include <osg/GL>
+#include <osg/GraphicsContext>
+#include <osg/Image>
+#include <osg/Viewport>
+#include <osgDB/FileNameUtils>
+#include <osgDB/WriteFile>
+#include <osgViewer/ViewerBase>
+
+#include <cctype>
+#include <cmath>
+#include <iostream>
+
+
+// frame read back once the scene is drawn
+class VideoCapture : public osg::Camera::DrawCallback
+{
+public :
+    VideoCapture (VideoExport* video) : video (video) {}
+
+    void operator() (osg::RenderInfo&) const
+    {
+	video->capture();
+    }
+
+private :
+    VideoExport* video;
+};
+
+// the render steps the simulation, unpaused, until maxTime
+class VideoControl : public osg::NodeCallback
+{
+public :
+    VideoControl (VideoExport* video) : video (video) {}
+
+    void operator() (osg::Node* node, osg::NodeVisitor* nv)
+    {
+	video->control();
+	traverse(node, nv);
+    }
+
+private :
+    VideoExport* video;
+};
+
+VideoExport::VideoExport (const std::string& filename, float period) :
+    filename (filename), period (period)
+{
+    render = NULL;
+    simulator = NULL;
+    next = 0.0;
+    captured = 0;
+    dropped = 0;
+    failed = false;
+    stopping = false;
+
+    // images are named after a single %d conversion (%% is a plain %),
+    // numbered otherwise ; the name is a printf format, it may hold no other
+    // conversion
+    int conversions = 0;
+    bool numbered = false;
+    for (size_t p = 0; p < filename.size(); p++)
+    {
+	if (filename[p] != '%')
+	    continue;
+	if (p + 1 < filename.size() && filename[p + 1] == '%')
+	{
+	    p++;
+	    continue;
+	}
+
+	size_t d = p + 1;
+	while (d < filename.size() && isdigit(filename[d]))
+	    d++;
+	numbered = d < filename.size() && filename[d] == 'd';
+	conversions++;
+    }
+
+    if (conversions > 1 && osgDB::getLowerCaseFileExtension(filename) != "y4m")
+    {
+	std::cerr << "VideoExport : " << filename << " holds more than one conversion, expected a single %d" << std::endl;
+	failed = true;
+    }
+    if (conversions == 1 && numbered)
+	pattern = filename;
+    else
+	pattern = escape(osgDB::getNameLessExtension(filename)) + "_%05d." + escape(osgDB::getFileExtension(filename));
+}
+
+// plain text given to printf as a format
+std::string VideoExport::escape (const std::string& text)
+{
+    std::string result;
+    for (char c : text)
+    {
+	result += c;
+	if (c == '%')
+	    result += '%';
+    }
+    return result;
+}
+
+VideoExport::~VideoExport ()
+{
+    close();
+}
+
+bool VideoExport::attach (RenderOSG* render, Simulator* simulator)
+{
+    if (failed)
+	return false;
+
+    this->render = render;
+    this->simulator = simulator;
+
+    osg::ref_ptr<osg::GraphicsContext::Traits> traits = new osg::GraphicsContext::Traits ();
+    traits->readDISPLAY();
+    traits->setUndefinedScreenDetailsToDefaultScreen();
+    traits->x = 0;
+    traits->y = 0;
+    traits->width = width;
+    traits->height = height;
+    traits->red = traits->green = traits->blue = 8;
+    traits->depth = 24;
+    traits->windowDecoration = false;
+    traits->doubleBuffer = false;
+    traits->pbuffer = true;
+
+    osg::ref_ptr<osg::GraphicsContext> context = osg::GraphicsContext::createGraphicsContext(traits.get());
+    osg::Node* scene = render ? render->viewer->getSceneData() : NULL;
+    if (!context.valid() || !scene)
+    {
+	std::cerr << "VideoExport : cannot create an offscreen context of " << width << "x" << height << std::endl;
+	return false;
+    }
+
+    // the render camera draws in the pbuffer instead of its window
+    osg::Camera* camera = render->viewer->getCamera();
+    double fovy, aspect, zNear, zFar;
+    camera->getProjectionMatrixAsPerspective(fovy, aspect, zNear, zFar);
+    camera->setGraphicsContext(context.get());
+    camera->setViewport(new osg::Viewport (0, 0, width, height));
+    camera->setProjectionMatrixAsPerspective(fovy, double(width) / height, zNear, zFar);
+    camera->setDrawBuffer(GL_FRONT);
+    camera->setReadBuffer(GL_FRONT);
+    camera->setFinalDrawCallback(new VideoCapture (this));
+    render->viewer->setThreadingModel(osgViewer::ViewerBase::SingleThreaded);
+    scene->addUpdateCallback(new VideoControl (this));
+
+    next = simulator->time;
+    encoder = std::thread (&VideoExport::encode, this);
+
+    return true;
+}
+
+bool VideoExport::close ()
+{
+    if (!encoder.joinable())
+	return !failed;
+
+    {
+	std::lock_guard<std::mutex> lock (mutex);
+	stopping = true;
+    }
+    ready.notify_one();
+    encoder.join();
+
+    std::cout << "VideoExport : " << captured - dropped << " frames written to " << filename;
+    if (dropped > 0)
+	std::cout << ", " << dropped << " dropped";
+    std::cout << std::endl;
+
+    return !failed;
+}
+
+void VideoExport::capture ()
+{
+    if (simulator->time < next)
+	return;
+
+    // periods the render stepped over have no frame, they count as dropped
+    // and their numbers are skipped so that images keep their time
+    int skipped = -1;
+    while (next <= simulator->time)
+    {
+	next += period;
+	skipped++;
+    }
+    captured += skipped;
+
+    std::unique_ptr<Frame> frame (new Frame ());
+    frame->index = captured++;
+    frame->rgb.resize(width * height * 3);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, frame->rgb.data());
+
+    std::lock_guard<std::mutex> lock (mutex);
+    dropped += skipped;
+    if (!keepAll && (int) queue.size() >= queueSize)
+    {
+	dropped++;
+	return;
+    }
+    queue.push_back(std::move(frame));
+    ready.notify_one();
+}
+
+void VideoExport::control ()
+{
+    render->setPaused(false);
+    if (Parameters::has("maxTime") && simulator->time >= Parameters::get("maxTime"))
+	render->viewer->setDone(true);
+}
+
+void VideoExport::encode ()
+{
+    std::FILE* video = NULL;
+    if (osgDB::getLowerCaseFileExtension(filename) == "y4m")
+    {
+	video = std::fopen(filename.c_str(), "wb");
+	if (video)
+	    std::fprintf(video, "YUV4MPEG2 W%d H%d F1000000:%ld Ip A1:1 C444\n", width, height, lround(period * 1e6));
+	else
+	{
+	    std::cerr << "VideoExport : cannot write " << filename << std::endl;
+	    failed = true;
+	}
+    }
+
+    for (;;)
+    {
+	std::unique_ptr<Frame> frame;
+	{
+	    std::unique_lock<std::mutex> lock (mutex);
+	    ready.wait(lock, [this] () { return stopping || !queue.empty(); });
+	    if (queue.empty())
+		break;
+	    frame = std::move(queue.front());
+	    queue.pop_front();
+	}
+
+	if (!failed && !write(video, *frame))
+	    failed = true;
+    }
+
+    if (video && std::fclose(video) != 0)
+    {
+	std::cerr << "VideoExport : cannot write " << filename << std::endl;
+	failed = true;
+    }
+}
+
+bool VideoExport::write (std::FILE* video, const Frame& frame)
+{
+    if (!video)
+    {
+	char name[4096];
+	snprintf(name, sizeof(name), pattern.c_str(), frame.index);
+
+	osg::ref_ptr<osg::Image> image = new osg::Image ();
+	image->setImage(width, height, 1, GL_RGB, GL_RGB, GL_UNSIGNED_BYTE,
+			const_cast<unsigned char*>(frame.rgb.data()), osg::Image::NO_DELETE);
+	image->flipVertical();
+	if (!osgDB::writeImageFile(*image, name))
+	{
+	    std::cerr << "VideoExport : cannot write " << name << std::endl;
+	    return false;
+	}
+	return true;
+    }
+
+    // BT.601 planes, top row first (OpenGL reads bottom up)
+    int n = width * height;
+    std::vector<unsigned char> yuv (3 * n);
+    for (int row = 0; row < height; row++)
+    {
+	const unsigned char* rgb = frame.rgb.data() + (height - 1 - row) * width * 3;
+	for (int x = 0; x < width; x++, rgb += 3)
+	{
+	    int r = rgb[0], g = rgb[1], b = rgb[2];
+	    int i = row * width + x;
+	    yuv[i] = ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16;
+	    yuv[n + i] = ((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128;
+	    yuv[2 * n + i] = ((112 * r - 94 * g - 18 * b + 128) >> 8) + 128;
+	}
+    }
+
+    return std::fputs("FRAME\n", video) >= 0 && std::fwrite(yuv.data(), 1, yuv.size(), video) == yuv.size();
+}
+
+#endif
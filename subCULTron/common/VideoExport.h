@@ -0,0 +1,92 @@
+/*----------------------------------------------------------------------------*/
+/*    Copyright (C) 2011-2017 Alexandre Campo                                 */
+/*                                                                            */
+/*    This file is part of FaMouS  (a fast, modular and simple simulator).    */
+/*                                                                            */
+/*    FaMouS is free software: you can redistribute it and/or modify          */
+/*    it under the terms of the GNU General Public License as published by    */
+/*    the Free Software Foundation, either version 3 of the License, or       */
+/*    (at your option) any later version.                                     */
+/*                                                                            */
+/*    FaMouS is distributed in the hope that it will be useful,               */
+/*    but WITHOUT ANY WARRANTY; without even the implied warranty of          */
+/*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the           */
+/*    GNU General Public License for more details.                            */
+/*                                                                            */
+/*    You should have received a copy of the GNU General Public License       */
+/*    along with FaMouS.  If not, see <http://www.gnu.org/licenses/>.         */
+/*----------------------------------------------------------------------------*/
+
+#ifndef VIDEO_EXPORT_H
+#define VIDEO_EXPORT_H
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class RenderOSG;
+class Simulator;
+
+// Renders the experiment without window, in an offscreen (pbuffer) context
+// of the render service, and writes a frame every `period` of simulated time
+// : a .y4m video (YUV4MPEG2, read by ffmpeg and most players) or numbered
+// images ("frames/%05d.png"). Frames are read back on the simulation thread
+// and encoded on a worker thread ; when it falls behind, frames are dropped
+// (queueSize) or, with keepAll, queued without limit. Periods shorter than
+// the render steps miss frames, which are counted as dropped too. The
+// simulation never waits for the encoder. The run goes unpaused until maxTime.
+class VideoExport
+{
+public :
+    // parameters
+    int width = 1280;
+    int height = 720;
+    int queueSize = 16;
+    bool keepAll = false;
+
+    // methods
+    VideoExport (const std::string& filename, float period);
+    ~VideoExport ();
+
+    bool attach (RenderOSG* render, Simulator* simulator);
+    bool close ();
+
+    // called by the render after each frame
+    void capture ();
+    void control ();
+
+private :
+    struct Frame
+    {
+	int index;
+	std::vector<unsigned char> rgb;
+    };
+
+    std::string filename;
+    std::string pattern;
+    float period;
+    RenderOSG* render;
+    Simulator* simulator;
+    float next;
+    int captured;
+    int dropped;
+    bool failed;
+
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<std::unique_ptr<Frame> > queue;
+    bool stopping;
+    std::thread encoder;
+
+    void encode ();
+    bool write (std::FILE* video, const Frame& frame);
+    static std::string escape (const std::string& text);
+};
+
+
+#endif
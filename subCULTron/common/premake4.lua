@@ -0,0 +1,43 @@
+
+
+solution "trajectory"
+   configurations { "debug", "release", "headless" }
+
+   --- ============================= LINUX ==================================
+   if os.is ("linux") then
+
+      links { "z" }
+
+   --- ============================= MACOSX =================================
+    elseif os.is ("macosx") then
+
+      libdirs { "/opt/local/lib" }
+      links { "z" }
+
+   end
+
+
+   --- ============================= GENERIC =================================
+
+   -- trajectory reader alone, without the simulator, for analysis scripts
+   project "trajectory"
+      kind "SharedLib"
+      language "C++"
+      files { "Trajectory.h", "Trajectory.cpp" }
+      files { "TrajectoryReader.h", "TrajectoryReader.cpp" }
+      files { "TrajectoryLibrary.h", "TrajectoryLibrary.cpp" }
+
+      configuration "release"
+         buildoptions {"-std=c++11"}
+         defines { "NDEBUG" }
+         flags { "OptimizeSpeed", "EnableSSE", "EnableSSE2", "FloatFast", "NoFramePointer"}    
+
+      configuration "headless"
+         buildoptions {"-std=c++11"}
+         defines { "NDEBUG", "HEADLESS" }
+         flags { "OptimizeSpeed", "EnableSSE", "EnableSSE2", "FloatFast", "NoFramePointer"}    
+
+      configuration "debug"
+         buildoptions {"-std=c++11"}
+         defines { "DEBUG" }
+         flags { "Symbols" }
@@ -0,0 +1,78 @@
+# Reads trajectory files recorded with --record, through libtrajectory
+# (built by the premake script of this directory).
+#
+#   t = Trajectory("run.traj")
+#   times, values = t.extract(10.0, 20.0, agents=[0, 1], channels=["x", "y"])
+#   values[sample, agent, channel]
+
+import ctypes
+import os
+
+import numpy
+
+
+class Trajectory:
+    def __init__(self, filename, library=None):
+        if library is None:
+            library = os.path.join(os.path.dirname(os.path.abspath(__file__)), "libtrajectory.so")
+        self.lib = ctypes.CDLL(library)
+
+        h = ctypes.c_void_p
+        self.lib.trajectory_open.restype = h
+        self.lib.trajectory_open.argtypes = [ctypes.c_char_p]
+        self.lib.trajectory_close.argtypes = [h]
+        self.lib.trajectory_agent_count.argtypes = [h]
+        self.lib.trajectory_channel_count.argtypes = [h]
+        self.lib.trajectory_channel_name.restype = ctypes.c_char_p
+        self.lib.trajectory_channel_name.argtypes = [h, ctypes.c_int]
+        for f in ("trajectory_period", "trajectory_start_time", "trajectory_end_time"):
+            getattr(self.lib, f).restype = ctypes.c_float
+            getattr(self.lib, f).argtypes = [h]
+        self.lib.trajectory_count.argtypes = [h, ctypes.c_float, ctypes.c_float]
+        self.lib.trajectory_extract.argtypes = [h, ctypes.c_float, ctypes.c_float,
+                                                ctypes.POINTER(ctypes.c_int), ctypes.c_int,
+                                                ctypes.POINTER(ctypes.c_int), ctypes.c_int,
+                                                ctypes.POINTER(ctypes.c_float), ctypes.POINTER(ctypes.c_float),
+                                                ctypes.c_int]
+
+        self.handle = self.lib.trajectory_open(filename.encode())
+        if not self.handle:
+            raise IOError("cannot read trajectory " + filename)
+
+        self.agents = self.lib.trajectory_agent_count(self.handle)
+        self.channels = [self.lib.trajectory_channel_name(self.handle, c).decode()
+                         for c in range(self.lib.trajectory_channel_count(self.handle))]
+        self.period = self.lib.trajectory_period(self.handle)
+        self.start = self.lib.trajectory_start_time(self.handle)
+        self.end = self.lib.trajectory_end_time(self.handle)
+
+    def close(self):
+        if self.handle:
+            self.lib.trajectory_close(self.handle)
+            self.handle = None
+
+    def __del__(self):
+        self.close()
+
+    def extract(self, start=None, end=None, agents=None, channels=None):
+        start = self.start if start is None else start
+        end = self.end if end is None else end
+        agents = range(self.agents) if agents is None else agents
+        channels = self.channels if channels is None else channels
+
+        a = numpy.array(list(agents), dtype=numpy.int32)
+        c = numpy.array([self.channels.index(x) if isinstance(x, str) else x for x in channels],
+                        dtype=numpy.int32)
+        n = self.lib.trajectory_count(self.handle, start, end)
+        times = numpy.empty(n, dtype=numpy.float32)
+        values = numpy.empty((n, len(a), len(c)), dtype=numpy.float32)
+
+        pi = ctypes.POINTER(ctypes.c_int)
+        pf = ctypes.POINTER(ctypes.c_float)
+        n = self.lib.trajectory_extract(self.handle, start, end,
+                                        a.ctypes.data_as(pi), len(a), c.ctypes.data_as(pi), len(c),
+                                        times.ctypes.data_as(pf), values.ctypes.data_as(pf), n)
+        if n < 0:
+            raise IndexError("agent or channel out of range")
+
+        return times[:n], values[:n]
@@ -20,6 +20,7 @@
 #include "ControllerAMussel.h"
 
 #include "Simulator.h"
+#include "Snapshot.h"
 
 #include <cmath>
 #include <iostream>
@@ -64,3 +65,10 @@ void ControllerAMussel::step ()
     // TODO DEBUG
     mussel->ballast->setBuoyancyFactor(1);
 }
+
+void ControllerAMussel::snapshot (Snapshot& s)
+{
+    // dynamic state only, parameters come from the command line
+    s.io(lastTime);
+    s.io(factor);
+}
@@ -24,6 +24,8 @@
 
 #include "aMussel.h"
 
+class Snapshot;
+
 class ControllerAMussel : public Controller
 {
 public : 
@@ -35,6 +37,7 @@ public :
     ControllerAMussel (aMussel* m);
     ~ControllerAMussel ();
     void reset();
+    void snapshot (Snapshot& s);
 
     void step ();
 };
@@ -20,6 +20,10 @@
 #include "ControllerAPad.h"
 
 #include "Simulator.h"
+#include "Snapshot.h"
+#include "Parameters.h"
+#include "Appearance.h"
+#include "Counters.h"
 
 #include <cmath>
 #include <iostream>
@@ -36,6 +40,11 @@ ControllerAPad::ControllerAPad (aPad* pad)
 {
     this->pad = pad;
 
+    // named parameters, shared by all the aPad controllers
+    PARAMETER(exploreMeanDuration);
+    PARAMETER(exploreSpeed);
+    PARAMETER(turnSpeed);
+
     reset();
 }
 
@@ -83,8 +92,10 @@ void ControllerAPad::step ()
 		
 	    // try to dock to first guy
 	    bool dockSuccess = pad->dockers[dockSlot]->dock();
+	    COUNT("dock.attempts");
 	    if (dockSuccess)
 	    {
+		COUNT("dock.successes");
 		dockSlot++;
 		fullDockedLastTime = time;		
 	    }
@@ -96,6 +107,7 @@ void ControllerAPad::step ()
 	{
 	    for (int i = 0; i < 4; i++)
 		pad->dockers[i]->undock();
+	    COUNT_N("dock.releases", 4);
 	}
 	if (time - fullDockedLastTime > 120)
 	{
@@ -126,7 +138,7 @@ void ControllerAPad::stateExploreInit ()
     state = EXPLORE;
 
     // set robot's colour
-    pad->setColor(1, 1, 55.0/254.0);
+    Appearance::setColor(pad, 1, 1, 55.0/254.0);
 }
 
 
@@ -200,7 +212,24 @@ void ControllerAPad::reset ()
     state = TURN;
     stateTurnInit(EXPLORE, M_PI);
 
+    // release mussels docked during a previous replicate
+    for (int i = 0; i < 4; i++)
+	pad->dockers[i]->undock();
     dockSlot = 0;
 }
 
-
+void ControllerAPad::snapshot (Snapshot& s)
+{
+    // dynamic state only, parameters come from the command line
+    s.io(state);
+    s.io(time);
+    s.io(dockSlot);
+    s.io(exploreDuration);
+    s.io(exploreStartTime);
+    s.io(turnPreviousState);
+    s.io(turnDuration);
+    s.io(turnStartTime);
+    s.io(turnSign);
+    s.io(collisionsDecisionLastTime);
+    s.io(fullDockedLastTime);
+}
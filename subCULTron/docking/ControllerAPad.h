@@ -23,6 +23,8 @@
 #include "Controller.h"
 #include "aPad.h"
 
+class Snapshot;
+
 class ControllerAPad : public Controller
 {
 public : 
@@ -66,6 +68,7 @@ public :
     void stateTurnInit (int previousState, float angle);
     void stateTurn ();
     void reset ();
+    void snapshot (Snapshot& s);
 };
 
 
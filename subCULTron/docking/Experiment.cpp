@@ -20,7 +20,10 @@
 // Services
 #include "Experiment.h"
 
+#ifndef HEADLESS
 #include "RenderOSG.h"
+#include "InstancedRender.h"
+#endif
 #include "PhysicsBullet.h"
 #include "WaterVolume.h"
 
@@ -36,6 +39,16 @@
 #include "Experiment.h"
 
 // Utilities
+#include "Parameters.h"
+#include "TrajectoryRecorder.h"
+#include "TrajectoryPlayer.h"
+#include "Appearance.h"
+#include "FastReset.h"
+#include "Interrupt.h"
+#include "Placement.h"
+#include "Profiler.h"
+#include "Counters.h"
+#include "Snapshot.h"
 #include <gsl/gsl_rng.h>
 #include <gsl/gsl_randist.h>
 #include <sys/time.h>
@@ -61,25 +74,39 @@ float getWaterVolumeHeight(btVector3 pos, float time)
 
 Experiment::Experiment (Simulator* simulator, bool graphics)
 {
+    // named parameters, may be overridden before the world is built
+    PARAMETER(aFishCount);
+    PARAMETER(aPadCount);
+    PARAMETER(aMusselCount);
+    PARAMETER(maxTime);
+    PARAMETER(aquariumRadius);
+    PARAMETER(recordPeriod);
+
     // random number generation
     init_rng(&rng);        
 
     // add services
     simulator->setTimestep (0.05);
-    physics = new PhysicsBullet();
+    physics = new Profiled<PhysicsBullet> ();
     physics->setTimestep(0.05);
-    simulator->add (physics);
+    Counters::world(physics);
+    // a replay sets the poses itself, the world is not simulated
+    if (!TrajectoryPlayer::replay)
+	simulator->add (physics);
 
-    waterVolume = new WaterVolume();
+    waterVolume = new Profiled<WaterVolume> ();
     waterVolume->setDensity(1000);
     waterVolume->setHeightCallback(getWaterVolumeHeight);
-    simulator->add (waterVolume);
+    if (!TrajectoryPlayer::replay)
+	simulator->add (waterVolume);
     
     render = NULL;
+#ifndef HEADLESS
     if (graphics)
     {	
-	render = new RenderOSG(simulator);
-	simulator->add (render);
+	render = new Profiled<RenderOSG> (simulator);
+	if (!InstancedRender::decoupled)
+	    simulator->add (render);
 
 	// setup camera of the render service
 	render->viewer->getCamera()->setProjectionMatrixAsPerspective(45.0, 1.0, 0.1, 1000); 
@@ -90,9 +117,13 @@ Experiment::Experiment (Simulator* simulator, bool graphics)
 	manip->setElevation(90.0 * M_PI / 180.0);
 	manip->setHeading(0.0 * M_PI / 180.0);
     }
+#endif
 
     // add the experiment so that we can step regularly
     simulator->add (this);
+
+    // trajectories, when a file is given on the command line
+    recorder = TrajectoryRecorder::create(recordPeriod);
     
     
     // add aMussels
@@ -101,18 +132,22 @@ Experiment::Experiment (Simulator* simulator, bool graphics)
 	aMussel* r = new aMussel ();
 	r->registerService(physics);
 	r->registerService(waterVolume);
+#ifndef HEADLESS
 	if (render) 
 	{
-	    r->setMeshFilename ("../3dmodels/aMussel_open.obj.(0.01,0.01,0.01).scale");
-	    r->registerService(render); 
+	    InstancedRender::add(render, r, "../3dmodels/aMussel_open.obj.(0.01,0.01,0.01).scale");
 	}
+#endif
 	r->addDevices();
 	r->setDragCoefficients(btVector3(0.3, 0.3, 1), btVector3(0.5, 0.5, 0.01));
 	r->setDragQuadraticCoefficients(btVector3(0,0,1), btVector3(0,0,0), waterVolume->density);
 
-	ControllerAMussel* c = new ControllerAMussel (r);
+	ControllerAMussel* c = new Profiled<ControllerAMussel> (r);
 	r->add(c);
 	c->setTimestep(0.1);
+	aMusselControllers.push_back(c);
+	if (recorder) recorder->add(r);
+	Counters::track(r);
 
 	aMussels.push_back(r);
 	simulator->add(r);   	
@@ -126,19 +161,23 @@ Experiment::Experiment (Simulator* simulator, bool graphics)
 	aPad* r = new aPad ();
 	r->registerService(physics);
 	r->registerService(waterVolume);
+#ifndef HEADLESS
 	if (render) 
 	{	    
-	    r->setMeshFilename ("../3dmodels/aPad.3ds.(0.025,0.025,0.025).scale");
-	    r->registerService(render); 
+	    InstancedRender::add(render, r, "../3dmodels/aPad.3ds.(0.025,0.025,0.025).scale");
 	}	
+#endif
 	r->addDevices();
 
 //	for (int j = 0; j < 1; j++)
 //	    r->dockers[1]->setDrawable(true);
 	
-	ControllerAPad* c = new ControllerAPad (r);	
+	ControllerAPad* c = new Profiled<ControllerAPad> (r);	
 	r->add(c);
 	c->setTimestep(0.1);
+	aPadControllers.push_back(c);
+	if (recorder) recorder->add(r, [c] () { return float(c->state); });
+	Counters::track(r);
 	
 	aPads.push_back(r);
 	simulator->add(r);   	
@@ -151,9 +190,17 @@ Experiment::Experiment (Simulator* simulator, bool graphics)
     AquariumCircular* aquarium = new AquariumCircular(aquariumRadius, 3.0, 40.0);
     aquarium->registerService(physics);
     aquarium->registerService(waterVolume);
+#ifndef HEADLESS
     if (render) aquarium->registerService(render);
+#endif
     simulator->add(aquarium);
 
+    // dynamic state, for checkpoints
+    Snapshot::provide([this] (Snapshot& s) { snapshot(s); });
+
+    if (recorder)
+	simulator->add (recorder);
+
     // set last stuff, position of robots mainly
     reset();
 }
@@ -164,22 +211,28 @@ Experiment::~Experiment()
 
 void Experiment::reset ()
 {
+    // the world is reused between replicates, only its dynamic state restarts
+    FastReset::time(simulator);
+
+    // agents are spread without overlapping each other
+    Placement placement;
+
     // reset aMussel
     for (unsigned int i = 0; i < aMussels.size(); i++)
     {
 	aMussel* r = aMussels[i];
 
 	// reset aMussel position
-	float distance = gsl_rng_uniform(rng) * 0.8 * aquariumRadius;
-	float angle = (gsl_rng_uniform(rng) * 2.0 * M_PI - M_PI);
-	float x = cos(angle) * distance;
-	float y = sin(angle) * distance;
+	btVector3 p = placement.disc(0.8 * aquariumRadius, r->dimensions);
+	float x = p.x();
+	float y = p.y();
 	float z = r->dimensions[2] / 2.0 + 1.0;
 	
 	r->setPosition (btVector3(x, y, z));
 	r->setRotation (btQuaternion(btVector3(0, 0, 1), gsl_rng_uniform(rng) * M_PI * 2.0 - M_PI));
+	FastReset::object<ControllerAMussel> (physics, r);
 
-	r->setColor (0.8, 0.0, 0.4, 0.0);
+	Appearance::setColor (r, 0.8, 0.0, 0.4, 0.0);
 	r->ballast->setBuoyancyFactor(0.0);
     }
 
@@ -188,18 +241,16 @@ void Experiment::reset ()
     {
 	aPad* r = aPads[i];
 
-	r->body->setLinearVelocity(btVector3(0,0,0));
-	r->body->setAngularVelocity(btVector3(0,0,0));
-
 	// reset position
-	float distance = gsl_rng_uniform(rng) * 0.8 * aquariumRadius;
-	float angle = (gsl_rng_uniform(rng) * 2.0 * M_PI - M_PI);
-	float x = cos(angle) * distance;
-	float y = sin(angle) * distance;
+	btVector3 p = placement.disc(0.8 * aquariumRadius, r->dimensions);
+	float x = p.x();
+	float y = p.y();
 	float z = r->dimensions[2] / 2.0 + 2.0;
 	
 	r->setPosition (btVector3(x, y, z));
 	r->setRotation (btQuaternion(btVector3(0, 0, 1), gsl_rng_uniform(rng) * M_PI * 2.0 - M_PI));
+	FastReset::object<ControllerAPad> (physics, r);
+	FastReset::propellers(r);
 
 	
 	// float k = (float)(i) / (float) (aPads.size());
@@ -225,16 +276,36 @@ void Experiment::step ()
 void Experiment::run()
 {
     // with render, give up control and stepping is done by render
+#ifndef HEADLESS
     if (render)
     {
 	render->setPaused (true);
 	render->run();
     }
     else
+#endif
     {
-	while(simulator->time < maxTime)
+	while(simulator->time < maxTime && !Interrupt::requested())
 	{
 	    simulator->step();
 	}
     }
+
+    if (recorder)
+	recorder->close();
+}
+
+void Experiment::snapshot (Snapshot& s)
+{
+    s.io(simulator->time);
+
+    // all bodies before the controllers
+    for (aMussel* r : aMussels)
+	s.body(r->body);
+    for (aPad* r : aPads)
+	s.body(r->body);
+    for (ControllerAMussel* c : aMusselControllers)
+	c->snapshot(s);
+    for (ControllerAPad* c : aPadControllers)
+	c->snapshot(s);
 }
@@ -31,9 +31,13 @@
 class PhysicsBullet;
 class WaterVolume;
 class RenderOSG;
+class TrajectoryRecorder;
 class aPad;
 class aFish;
 class aMussel;
+class ControllerAPad;
+class ControllerAMussel;
+class Snapshot;
 
 class Experiment : public Service
 {
@@ -43,11 +47,14 @@ public:
     PhysicsBullet* physics;
     WaterVolume* waterVolume;
     RenderOSG* render;
+    TrajectoryRecorder* recorder;
 
     // objects
     std::vector<aFish*> aFishes;
     std::vector<aPad*> aPads;
     std::vector<aMussel*> aMussels;
+    std::vector<ControllerAPad*> aPadControllers;
+    std::vector<ControllerAMussel*> aMusselControllers;
 	
     // parameters
     int aFishCount = 0;
@@ -55,6 +62,7 @@ public:
     int aMusselCount = 10;
     float maxTime = 3600;
     float aquariumRadius = 3.0;    
+    float recordPeriod = 0.1;
     
     // methods
     Experiment (Simulator* s, bool graphics);
@@ -63,6 +71,7 @@ public:
     void reset ();
     void step ();
     void run();
+    void snapshot (Snapshot& s);
 };
 
 
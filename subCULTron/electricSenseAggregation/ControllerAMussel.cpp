@@ -20,6 +20,8 @@
 #include "ControllerAMussel.h"
 
 #include "Simulator.h"
+#include "Appearance.h"
+#include "Counters.h"
 
 #include <cmath>
 #include <iostream>
@@ -57,6 +59,7 @@ void ControllerAMussel::step ()
     mussel->esense->setPolarization (pola);
     // read e-sense
     mussel->esense->getCurrents();
+    COUNT("esense.solves");
     
     if (mussel->esense->I(0)==0)
     {*/
@@ -65,11 +68,12 @@ void ControllerAMussel::step ()
     mussel->esense->setPolarization (pola);
     // read e-sense
     mussel->esense->getCurrents();
-    mussel->setColor(1, 0, 0);
+    COUNT("esense.solves");
+    Appearance::setColor(mussel, 1, 0, 0);
  /*   }
     else 
     {
-    mussel->setColor(1, 1, 55.0/254.0);
+    Appearance::setColor(mussel, 1, 1, 55.0/254.0);
     }*/
 
  /*   cout << "E-sense current measured : ";    
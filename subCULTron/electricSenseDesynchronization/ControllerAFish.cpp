@@ -18,8 +18,13 @@
 /*----------------------------------------------------------------------------*/
 
 #include "ControllerAFish.h"
+#include "ObstacleAvoidance.h"
 
 #include "Simulator.h"
+#include "Parameters.h"
+#include "Appearance.h"
+#include "Counters.h"
+#include "Log.h"
 
 #include <cmath>
 #include <iostream>
@@ -41,6 +46,14 @@ ControllerAFish::ControllerAFish (aFish* fish)
 {
     this->fish = fish;
 
+    // named parameters, shared by all the aFish controllers
+    PARAMETER(obstacleAvoidanceSpeed);
+    PARAMETER(exploreMeanDuration);
+    PARAMETER(exploreSpeed);
+    PARAMETER(turnSpeed);
+    PARAMETER(counter_threshold);
+    PARAMETER(counter_max);
+
     reset();
 }
 
@@ -53,26 +66,25 @@ void ControllerAFish::step ()
     
 // update ffcounter
     counter += 1.0 * getTimestep();
-cout << "counter : ";    
-  	cout << counter << " ";
-	cout << actif_passif << " ";
-    	cout << endl;
+    LOG_IF(LOG_DEBUG, dbg) << "counter : " << counter << " " << actif_passif;
 
     if (counter <= counter_threshold) 
     {
-        cout << "PASSIF " << endl;
-        fish->setColor(1, 1, 55.0/254.0);
+        LOG_IF(LOG_DEBUG, dbg) << "PASSIF ";
+        Appearance::setColor(fish, 1, 1, 55.0/254.0);
         // passif
         pola << 0, 0, 0, 0, 0;
         fish->esense->setPolarization (pola);
         // read e-sense
         fish->esense->getCurrents();
-	cout << "E-sense current measured : ";    
-    	for (int i = 0; i < fish->esense->numElectrodes; i++)
-    	{
-	     cout << fish->esense->I(i) << " ";
-    	}
-        cout << endl;
+        COUNT("esense.solves");
+        if (LOG_ENABLED(LOG_DEBUG, dbg))
+        {
+            Log::Line line (LOG_DEBUG);
+            line << "E-sense current measured : ";
+            for (int i = 0; i < fish->esense->numElectrodes; i++)
+                line << fish->esense->I(i) << " ";
+        }
         if ((fish->esense->I(0)==0))// && (actif_passif == 1))
         {
             actif_passif = 0;
@@ -81,27 +93,26 @@ cout << "counter : ";
         {
            // counter = counter -  1*counter_threshold;
             counter -= 1.0* getTimestep();
-            cout << "counter delayed ";
-	    cout << counter << " ";
-    	    cout << endl;
+            LOG_IF(LOG_DEBUG, dbg) << "counter delayed " << counter;
 	    actif_passif = 1;
-            fish->setColor(0, 1, 0);
+            Appearance::setColor(fish, 0, 1, 0);
         }
     }
     else
     {
-        cout << "actIF " << endl;
+        LOG_IF(LOG_DEBUG, dbg) << "actIF ";
         // actif
         pola << 10, 0, 0, 0, 0;
         fish->esense->setPolarization (pola);
         // read e-sense
         fish->esense->getCurrents();
-        fish->setColor(1, 0, 0);
+        COUNT("esense.solves");
+        Appearance::setColor(fish, 1, 0, 0);
     }
     if (counter>=counter_max)
     {
-        cout << "max " << endl;
-        fish->setColor(1, 1, 55.0/254.0);
+        LOG_IF(LOG_DEBUG, dbg) << "max ";
+        Appearance::setColor(fish, 1, 1, 55.0/254.0);
         // passif
         pola << 0, 0, 0, 0, 0;
         fish->esense->setPolarization (pola);
@@ -111,17 +122,20 @@ cout << "counter : ";
 
     // read e-sense
     fish->esense->getCurrents();
+    COUNT("esense.solves");
 
     
     
     
     // send a message
     fish->optical->send(1);
+    COUNT("optical.sent");
     
     // receive messages
     DeviceOpticalTransceiver::Message msg;
     while (fish->optical->receive(msg))
     {
+	COUNT("optical.received");
 //	if (dbg) cout << this << " fish received msg " << msg.content << " at time " << time << endl;
     }
 
@@ -142,7 +156,7 @@ void ControllerAFish::stateExploreInit ()
     state = EXPLORE;
 
     // set robot's colour
-    fish->setColor(1, 1, 55.0/254.0);
+    Appearance::setColor(fish, 1, 1, 55.0/254.0);
 }
 
 
@@ -222,58 +236,8 @@ void ControllerAFish::stateTurn()
 
 
 bool ControllerAFish::obstacleAvoidance()
-{    
-    // check if an obstacle is perceived 
-    int obstaclePerceived = 0;
-
-    float pl = fish->rayFrontLU->getValue() + fish->rayFrontLD->getValue() + fish->rayLeft->getValue();
-    float pr = fish->rayFrontRU->getValue() + fish->rayFrontRD->getValue() + fish->rayRight->getValue();
-    pl /= 3.0;
-    pr /= 3.0;   
-
-    // don't take into account down obstacles, as it can be the ground...
-    if (fish->rayFrontLU->hasHit()
-//	|| fish->rayFrontLD->hasHit()
-	|| fish->rayFrontRU->hasHit()
-//	|| fish->rayFrontRD->hasHit()
-	|| fish->rayLeft->hasHit()
-	|| fish->rayRight->hasHit()
-	)
-	obstaclePerceived = 1;	    
-    
-    // no obstacles to avoid, return immediately
-    if (obstaclePerceived == 0)
-	return false;
-    
-    float leftSpeed = 0.0;
-    float rightSpeed = 0.0;
-
-    // proportional break
-    if (pr > obstacleAvoidanceThreshold && pl > obstacleAvoidanceThreshold)
-    {
-	// break symmetry
-	leftSpeed = -breakSpeed * pr / (pr + pl);
-	rightSpeed = -breakSpeed * pl / (pr + pl);	
-    }
-    // turn left
-    if (pr >= pl)
-    {
-	leftSpeed = -obstacleAvoidanceSpeed;
-	rightSpeed = obstacleAvoidanceSpeed;
-    }
-    // turn right
-    else
-    {
-	leftSpeed = obstacleAvoidanceSpeed;
-	rightSpeed = -obstacleAvoidanceSpeed;
-    }
-    
-    // change movement direction
-    fish->propellerLeft->setSpeed(leftSpeed);
-    fish->propellerRight->setSpeed(rightSpeed);
-
-    // advertise obstacle avoidance in progress
-    return true;
+{
+    return ObstacleAvoidance::avoid(fish, obstacleAvoidanceSpeed);
 }
 
 
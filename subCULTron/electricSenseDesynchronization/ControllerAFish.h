@@ -32,13 +32,11 @@ public :
     float counter, counter_threshold = 2.5,counter_max = 5.0;
 
     // parameters
-    float obstacleAvoidanceThreshold = 0.05;
 //    float maxProximitySensing = 0.12;
     float obstacleAvoidanceSpeed = 0.99;
     float exploreMeanDuration = 5.0;
     float exploreSpeed = 0.05;
     float turnSpeed = 0.3;
-    float breakSpeed = 1;
 
     // state handling
     int state;
@@ -1,5 +1,8 @@
 #!/usr/bin/env bash
 
+# optional configuration : debug (default), release or headless
+config=$1
+
 dirs=`find . -maxdepth 2 -name premake4.lua -exec dirname {} \;`
 
 echo $dirs
@@ -12,7 +15,7 @@ do
        
     cd $i
     premake4 gmake
-    make clean
-    make
+    make clean ${config:+config=$config}
+    make ${config:+config=$config}
     cd ..
 done
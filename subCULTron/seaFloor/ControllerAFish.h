@@ -29,13 +29,11 @@ public :
     aFish* fish;
     
     // parameters
-    float obstacleAvoidanceThreshold = 0.05;
 //    float maxProximitySensing = 0.12;
     float obstacleAvoidanceSpeed = 0.99;
     float exploreMeanDuration = 1.0;
     float exploreSpeed = 0.05;
     float turnSpeed = 0.3;
-    float breakSpeed = 1;
 
     // state handling
     int state;